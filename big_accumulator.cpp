@@ -0,0 +1,93 @@
+#include "big_accumulator.h"
+#include "mpn.h"
+#include "workspace.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+big_accumulator::big_accumulator() = default;
+
+big_accumulator::big_accumulator(const big_accumulator& other) = default;
+
+big_accumulator::~big_accumulator() = default;
+
+big_accumulator& big_accumulator::operator=(const big_accumulator& other) = default;
+
+big_accumulator& big_accumulator::operator+=(const big_integer& a) {
+    accumulate(a.limbs(), a.is_negative);
+    return *this;
+}
+
+big_accumulator& big_accumulator::operator-=(const big_integer& a) {
+    accumulate(a.limbs(), !a.is_negative);
+    return *this;
+}
+
+void big_accumulator::add_product(const big_integer& a, const big_integer& b) {
+    accumulate_product(a, b, a.is_negative != b.is_negative);
+}
+
+void big_accumulator::sub_product(const big_integer& a, const big_integer& b) {
+    accumulate_product(a, b, a.is_negative == b.is_negative);
+}
+
+big_integer big_accumulator::sum() const {
+    return to_big_integer(positive) - to_big_integer(negative);
+}
+
+void big_accumulator::clear() {
+    positive.clear();
+    negative.clear();
+    pending = 0;
+}
+
+void big_accumulator::accumulate(std::span<const uint32_t> a, bool is_negative) {
+    if (pending == MAX_PENDING) {
+        normalize(positive);
+        normalize(negative);
+        pending = 1;
+    }
+    ++pending;
+    std::vector<uint64_t>& lanes = is_negative ? negative : positive;
+    if (lanes.size() < a.size()) {
+        lanes.resize(a.size(), 0);
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        lanes[i] += a[i];
+    }
+}
+
+void big_accumulator::accumulate_product(const big_integer& a, const big_integer& b, bool is_negative) {
+    if (a == 0 || b == 0) {
+        return;
+    }
+    workspace_frame frame;
+    size_t size = a.limbs().size() + b.limbs().size();
+    std::span<uint32_t> product(frame.allocate(size), size);
+    mpn::mul(product, a.limbs(), b.limbs());
+    accumulate(product, is_negative);
+}
+
+void big_accumulator::normalize(std::vector<uint64_t>& lanes) {
+    uint64_t carry = 0;
+    for (uint64_t& lane : lanes) {
+        uint64_t cur = lane + carry;
+        lane = cur & UINT32_MAX;
+        carry = cur >> std::numeric_limits<uint32_t>::digits;
+    }
+    while (carry != 0) {
+        lanes.push_back(carry & UINT32_MAX);
+        carry >>= std::numeric_limits<uint32_t>::digits;
+    }
+}
+
+big_integer big_accumulator::to_big_integer(std::vector<uint64_t> lanes) {
+    normalize(lanes);
+    big_integer result;
+    result.value.assign(lanes.begin(), lanes.end());
+    result.skip_leading_zeros();
+    return result;
+}
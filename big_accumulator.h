@@ -0,0 +1,44 @@
+#pragma once
+
+#include "big_integer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Sum of many signed big integers. Positive and negative terms are added into separate arrays of 64-bit
+// lanes that each hold a 32-bit digit and the carries deferred into its upper half, so an addition is a
+// single pass without carry propagation or sign logic. Carries are only resolved before the lanes could
+// overflow and when the sum is read.
+struct big_accumulator {
+public:
+    big_accumulator();
+    big_accumulator(const big_accumulator& other);
+    ~big_accumulator();
+
+    big_accumulator& operator=(const big_accumulator& other);
+
+    big_accumulator& operator+=(const big_integer& a);
+    big_accumulator& operator-=(const big_integer& a);
+    void add_product(const big_integer& a, const big_integer& b);
+    void sub_product(const big_integer& a, const big_integer& b);
+
+    big_integer sum() const;
+    void clear();
+
+private:
+    // Every addition adds less than 2^32 to a lane, so lanes holding at most this many additions can still
+    // take a carry of up to 2^32 without overflowing.
+    static const uint64_t MAX_PENDING = UINT32_MAX - 1;
+
+    std::vector<uint64_t> positive;
+    std::vector<uint64_t> negative;
+    uint64_t pending = 0;
+
+    void accumulate(std::span<const uint32_t> a, bool is_negative);
+    void accumulate_product(const big_integer& a, const big_integer& b, bool is_negative);
+
+    static void normalize(std::vector<uint64_t>& lanes);
+    static big_integer to_big_integer(std::vector<uint64_t> lanes);
+};
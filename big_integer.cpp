@@ -1,17 +1,70 @@
 #include "big_integer.h"
+#include "big_integer_view.h"
+#include "instrumentation.h"
+#include "mpn.h"
+#include "thread_pool.h"
+#include "workspace.h"
+// Searched on the include path only, so a header generated by the tune target shadows the checked-in one.
+#include <tuned_thresholds.h>
 
-#include <cassert>
+#include <algorithm>
+#include <bit>
 #include <cstddef>
 #include <cstring>
 #include <cstdint>
 #include <functional>
 #include <limits>
+#include <memory>
+#include <memory_resource>
 #include <ostream>
+#include <span>
 #include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
 
-big_integer::big_integer() = default;
+namespace {
 
-big_integer::big_integer(const big_integer& other) = default;
+const size_t STRING_RADIX_DIGITS = std::numeric_limits<uint32_t>::digits10;
+// Pieces of streamed decimal output are converted into buffers of at most this many digits.
+const size_t STREAM_CHUNK_DIGITS = STRING_RADIX_DIGITS << 12;
+
+parallel_options current_options;
+algorithm_thresholds current_thresholds = TUNED_THRESHOLDS;
+std::unique_ptr<thread_pool> pool;
+
+thread_local std::pmr::memory_resource* current_resource = nullptr;
+
+// The limbs of a, one if they fit.
+std::span<const uint32_t> split_limbs(uint64_t a, uint32_t (&digits)[2]) {
+    digits[0] = static_cast<uint32_t>(a & UINT32_MAX);
+    digits[1] = static_cast<uint32_t>(a >> std::numeric_limits<uint32_t>::digits);
+    return std::span<const uint32_t>(digits, digits[1] != 0 ? 2 : 1);
+}
+
+} // namespace
+
+std::pmr::memory_resource* big_integer_memory_resource() {
+    return instrumentation::counting_resource(current_resource != nullptr ? current_resource
+                                                                          : std::pmr::get_default_resource());
+}
+
+big_integer_memory_scope::big_integer_memory_scope(std::pmr::memory_resource* resource)
+        : previous(current_resource) {
+    current_resource = resource;
+}
+
+big_integer_memory_scope::~big_integer_memory_scope() {
+    current_resource = previous;
+}
+
+big_integer::big_integer() : value(big_integer_memory_resource()) {}
+
+big_integer::big_integer(const big_integer& other)
+        : value(big_integer_memory_resource()), is_negative(other.is_negative) {
+    instrumentation::count_copy(other.limbs().size());
+    assign_limbs(other.limbs());
+}
 
 big_integer::big_integer(int a) : big_integer(static_cast<long long>(a)) {}
 
@@ -21,17 +74,12 @@ big_integer::big_integer(long a) : big_integer(static_cast<long long>(a)) {}
 
 big_integer::big_integer(unsigned long a) : big_integer(static_cast<unsigned long long>(a)) {}
 
-big_integer::big_integer(long long a)
-        : big_integer(static_cast<unsigned long long>(a == INT64_MIN ? INT64_MAX + 1ull : std::abs(a))) {
-    is_negative = a < 0;
+big_integer::big_integer(long long a) : big_integer() {
+    set_int64(a);
 }
 
 big_integer::big_integer(unsigned long long a) : big_integer() {
-    do {
-        value.push_back(static_cast<uint32_t>(a & UINT32_MAX));
-        a >>= std::numeric_limits<uint32_t>::digits;
-    } while (a > 0);
-    skip_leading_zeros();
+    set_inline(a, false);
 }
 
 big_integer::big_integer(const std::string& str) : big_integer() {
@@ -50,23 +98,20 @@ big_integer::big_integer(const std::string& str) : big_integer() {
             throw std::invalid_argument(R"(String can't be only "-" or "+")");
         }
     }
-    uint32_t cur_digit = 0;
-    uint32_t cur_radix = 1;
-    for (; i < str.size(); ++i) {
-        cur_digit = cur_digit * big_integer::CHAR_RADIX + (str[i] - '0');
-        cur_radix *= big_integer::CHAR_RADIX;
-        if (cur_radix == big_integer::STRING_RADIX) {
-            this->mul_to_short(big_integer::STRING_RADIX);
-            this->add_to_short(cur_digit);
-            cur_digit = 0;
-            cur_radix = 1;
+    size_t length = str.size() - i;
+    size_t count = 0;
+    if (length > current_thresholds.decimal_conversion * STRING_RADIX_DIGITS) {
+        count = 1;
+        while ((STRING_RADIX_DIGITS << count) < length) {
+            ++count;
         }
     }
-    if (cur_radix != 1) {
-        this->mul_to_short(cur_radix);
-        this->add_to_short(cur_digit);
-    }
-    if (*this != 0) {
+    value.resize((length + STRING_RADIX_DIGITS - 1) / STRING_RADIX_DIGITS);
+    instrumentation::timed_operation operation(
+        count > 0 ? algorithm_tier::subquadratic_conversion : algorithm_tier::quadratic_conversion, value.size());
+    from_decimal(str.data() + i, length, decimal_powers(count), value, pool.get());
+    skip_leading_zeros();
+    if (!(*this == 0)) {
         is_negative = str[0] == '-';
     }
 }
@@ -80,12 +125,109 @@ big_integer& big_integer::operator=(const big_integer& other) {
     return *this;
 }
 
+// Limbs from different resources can't change owners, so they are copied across instead.
 void big_integer::swap(big_integer& other) {
-    std::swap(value, other.value);
+    if (value.get_allocator() == other.value.get_allocator()) {
+        value.swap(other.value);
+    } else {
+        instrumentation::count_copy(2 * value.size() + other.value.size());
+        std::pmr::vector<uint32_t> temp(value, value.get_allocator());
+        value.assign(other.value.begin(), other.value.end());
+        other.value.assign(temp.begin(), temp.end());
+    }
+    std::swap(inline_value, other.inline_value);
     std::swap(is_negative, other.is_negative);
 }
 
+std::span<const uint32_t> big_integer::limbs() const {
+    if (!value.empty()) {
+        return value;
+    }
+    return std::span(inline_value, inline_value[1] != 0 ? 2 : 1);
+}
+
+// True if the magnitude fits into 64 bits, whichever way it is stored.
+bool big_integer::get_inline(uint64_t& magnitude) const {
+    std::span<const uint32_t> digits = limbs();
+    if (digits.size() > std::size(inline_value)) {
+        return false;
+    }
+    magnitude = digits[0];
+    if (digits.size() > 1) {
+        magnitude |= static_cast<uint64_t>(digits[1]) << std::numeric_limits<uint32_t>::digits;
+    }
+    return true;
+}
+
+bool big_integer::get_int64(int64_t& result) const {
+    uint64_t magnitude;
+    if (!get_inline(magnitude) || magnitude > INT64_MAX) {
+        return false;
+    }
+    result = is_negative ? -static_cast<int64_t>(magnitude) : static_cast<int64_t>(magnitude);
+    return true;
+}
+
+// Limbs already allocated are kept, so a number that shrinks and grows again doesn't reallocate.
+void big_integer::set_inline(uint64_t magnitude, bool negative) {
+    value.clear();
+    inline_value[0] = static_cast<uint32_t>(magnitude & UINT32_MAX);
+    inline_value[1] = static_cast<uint32_t>(magnitude >> std::numeric_limits<uint32_t>::digits);
+    is_negative = negative && magnitude != 0;
+}
+
+void big_integer::set_int64(int64_t a) {
+    set_inline(a < 0 ? 0 - static_cast<uint64_t>(a) : static_cast<uint64_t>(a), a < 0);
+}
+
+// *this += (negative ? -magnitude : magnitude) if *this fits into 64 bits and the sum does too.
+bool big_integer::add_inline(uint64_t magnitude, bool negative) {
+    uint64_t left;
+    if (!get_inline(left)) {
+        return false;
+    }
+    if (is_negative == negative) {
+        if (left + magnitude < left) {
+            return false;
+        }
+        set_inline(left + magnitude, negative);
+    } else if (left >= magnitude) {
+        set_inline(left - magnitude, is_negative);
+    } else {
+        set_inline(magnitude - left, negative);
+    }
+    return true;
+}
+
+// Stores the magnitude with the given limbs, inline if it fits.
+void big_integer::assign_limbs(std::span<const uint32_t> digits) {
+    while (digits.size() > 1 && digits.back() == 0) {
+        digits = digits.first(digits.size() - 1);
+    }
+    if (digits.size() > std::size(inline_value)) {
+        value.assign(digits.begin(), digits.end());
+        return;
+    }
+    value.clear();
+    inline_value[0] = digits.empty() ? 0 : digits[0];
+    inline_value[1] = digits.size() > 1 ? digits[1] : 0;
+}
+
+// Moves an inline magnitude into value before code that works on the limbs directly.
+void big_integer::promote() {
+    if (value.empty()) {
+        std::span<const uint32_t> digits = limbs();
+        value.assign(digits.begin(), digits.end());
+        inline_value[0] = 0;
+        inline_value[1] = 0;
+    }
+}
+
 big_integer& big_integer::operator+=(const big_integer& rhs) {
+    uint64_t magnitude;
+    if (rhs.get_inline(magnitude) && add_inline(magnitude, rhs.is_negative)) {
+        return *this;
+    }
     if (is_negative != rhs.is_negative) {
         is_negative = !is_negative;
         *this -= rhs;
@@ -94,115 +236,84 @@ big_integer& big_integer::operator+=(const big_integer& rhs) {
         }
         return *this;
     }
-    size_t left_size = value.size();
-    size_t right_size = rhs.value.size();
-    value.resize(std::max(left_size, right_size) + 1);
-    bool carry = false;
-    for (size_t i = 0; i < value.size() - 1; ++i) {
-        uint64_t digit = (carry ? 1 : 0);
-        if (i < left_size) {
-            digit += value[i];
-        }
-        if (i < right_size) {
-            digit += rhs.value[i];
-        }
-        carry = digit > UINT32_MAX;
-        if (carry) {
-            digit -= UINT32_MAX;
-            --digit;
-        }
-        value[i] = static_cast<uint32_t>(digit);
+    promote();
+    size_t right_size = rhs.limbs().size();
+    if (value.size() < right_size) {
+        value.resize(right_size, 0);
     }
-    if (carry) {
-        value[value.size() - 1] = 1;
-    } else {
-        value.pop_back();
+    uint32_t carry = mpn::add(value, value, rhs.limbs());
+    if (carry != 0) {
+        value.push_back(carry);
     }
     return *this;
 }
 
-big_integer& big_integer::add_to_short(uint32_t rhs) {
+big_integer& big_integer::add_to_short(uint64_t rhs) {
+    if (add_inline(rhs, false)) {
+        return *this;
+    }
     if (is_negative) {
         is_negative = false;
         sub_to_short(rhs);
         if (*this != 0) {
-            is_negative = true;
+            is_negative = !is_negative;
         }
         return *this;
     }
-    if (value.empty()) {
-        value.resize(1, rhs);
-        return *this;
+    promote();
+    uint32_t digits[2];
+    std::span<const uint32_t> right = split_limbs(rhs, digits);
+    if (value.size() < right.size()) {
+        value.resize(right.size(), 0);
     }
-    uint64_t first_digit = static_cast<uint64_t>(value[0]) + static_cast<uint64_t>(rhs);
-    bool carry = first_digit > UINT32_MAX;
-    if (carry) {
-        first_digit -= UINT32_MAX;
-        --first_digit;
-        for (size_t i = 1; i < value.size(); ++i) {
-            if (value[i] == UINT32_MAX) {
-                value[i] = 0;
-            } else {
-                ++value[i];
-                carry = false;
-                break;
-            }
-        }
-        if (carry) {
-            value.push_back(1);
-        }
+    uint32_t carry = mpn::add(value, value, right);
+    if (carry != 0) {
+        value.push_back(carry);
     }
-    value[0] = static_cast<uint32_t>(first_digit);
     return *this;
 }
 
-big_integer& big_integer::sub_to_short(uint32_t rhs) {
+// Only magnitudes above 64 bits reach the limbs, so they never drop below rhs.
+big_integer& big_integer::sub_to_short(uint64_t rhs) {
+    if (add_inline(rhs, true)) {
+        return *this;
+    }
     if (is_negative) {
         is_negative = false;
-        *this += rhs;
+        add_to_short(rhs);
         if (*this != 0) {
-            is_negative = true;
+            is_negative = !is_negative;
         }
         return *this;
     }
-    if (value.empty()) {
-        value.resize(1, rhs);
-        is_negative = true;
-        return *this;
-    }
-    int64_t first_digit = static_cast<int64_t>(value[0]) - static_cast<int64_t>(rhs);
-    if (first_digit < 0) {
-        if (value.size() == 1) {
-            value[0] = static_cast<uint32_t>(std::abs(first_digit));
-            is_negative = true;
-            return *this;
-        } else {
-            first_digit += UINT32_MAX;
-            first_digit++;
-            for (size_t i = 1; i < value.size(); ++i) {
-                if (value[i] == 0) {
-                    value[i] = UINT32_MAX;
-                } else {
-                    --value[i];
-                    break;
-                }
-            }
-            skip_leading_zeros();
-        }
-    }
-    value[0] = static_cast<uint32_t>(first_digit);
+    promote();
+    uint32_t digits[2];
+    mpn::sub(value, value, split_limbs(rhs, digits));
+    skip_leading_zeros();
     return *this;
 }
 
 void big_integer::skip_leading_zeros() {
+    if (value.size() > 1 && value.back() == 0) {
+        instrumentation::count_shrink();
+    }
     while (value.size() > 1 && value.back() == 0) {
         value.pop_back();
     }
 }
 
+size_t big_integer::bit_length() const {
+    if (*this == 0) {
+        return 0;
+    }
+    std::span<const uint32_t> digits = limbs();
+    return (digits.size() - 1) * std::numeric_limits<uint32_t>::digits + std::bit_width(digits.back());
+}
+
 big_integer& big_integer::operator-=(const big_integer& rhs) {
-    if (*this == rhs) {
-        return *this = 0;
+    uint64_t magnitude;
+    if (rhs.get_inline(magnitude) && add_inline(magnitude, !rhs.is_negative)) {
+        return *this;
     }
     if (is_negative != rhs.is_negative) {
         is_negative = !is_negative;
@@ -212,155 +323,222 @@ big_integer& big_integer::operator-=(const big_integer& rhs) {
         }
         return *this;
     }
-    if (rhs.value.size() > value.size()) {
-        value.resize(rhs.value.size(), 0);
-    }
-    bool is_abs_left_greater = (*this > rhs) != is_negative;
-    bool borrow = false;
-    for (size_t i = 0; i < value.size(); ++i) {
-        int64_t digit = (is_abs_left_greater ? value[i] : rhs.value[i]);
-        if (i < rhs.value.size()) {
-            digit -= (is_abs_left_greater ? rhs.value[i] : value[i]);
-        }
-        if (borrow) {
-            --digit;
-        }
-        borrow = digit < 0;
-        value[i] = static_cast<uint32_t>(digit);
+    promote();
+    size_t left_size = value.size();
+    size_t right_size = rhs.limbs().size();
+    bool is_abs_left_less = left_size != right_size
+                            ? left_size < right_size
+                            : mpn::cmp(value, rhs.limbs()) < 0;
+    if (is_abs_left_less) {
+        value.resize(right_size, 0);
+        mpn::sub(value, rhs.limbs(), std::span(value.data(), left_size));
+        is_negative = !is_negative;
+    } else {
+        mpn::sub(value, value, rhs.limbs());
     }
-    is_negative = is_negative == is_abs_left_greater;
     skip_leading_zeros();
+    if (value.size() == 1 && value[0] == 0) {
+        is_negative = false;
+    }
     return *this;
 }
 
 big_integer& big_integer::operator*=(const big_integer& rhs) {
+    uint64_t right;
+    if (rhs.get_inline(right)) {
+        bool negate = rhs.is_negative;
+        mul_to_short(right);
+        if (*this != 0 && negate) {
+            is_negative = !is_negative;
+        }
+        return *this;
+    }
     if (*this == 0 || rhs == 0) {
         return *this = 0;
     }
-    size_t left_size = value.size();
-    size_t right_size = rhs.value.size();
-    uint32_t carry = 0;
-    value.resize(left_size + right_size + 1, 0);
-    for (size_t i = left_size; i > 0; --i) {
-        carry = 0;
-        uint64_t cur_digit = value[i - 1];
-        for (size_t j = 0; j < right_size || carry > 0; ++j) {
-            uint64_t cur = carry;
-            if (j < right_size) {
-                cur += cur_digit * static_cast<uint64_t>(rhs.value[j]);
-            }
-            if (j > 0) {
-                cur += value[i + j - 1];
-            }
-            value[i + j - 1] = static_cast<uint32_t>(cur);
-            carry = static_cast<uint32_t>(cur >> std::numeric_limits<uint32_t>::digits);
-        }
+    promote();
+    size_t n = value.size();
+    size_t m = rhs.limbs().size();
+    workspace_frame frame;
+    std::span<uint32_t> result(frame.allocate(n + m), n + m);
+    if (this == &rhs) {
+        mpn::sqr(result, value, pool.get());
+    } else {
+        mpn::mul(result, value, rhs.limbs(), pool.get());
     }
+    value.assign(result.begin(), result.end());
     is_negative = is_negative != rhs.is_negative;
     skip_leading_zeros();
     return *this;
 }
 
-big_integer& big_integer::mul_to_short(uint32_t rhs) {
+big_integer& big_integer::mul_to_short(uint64_t rhs) {
+    uint64_t left;
+    if (get_inline(left) && std::bit_width(left) + std::bit_width(rhs) <= std::numeric_limits<uint64_t>::digits) {
+        set_inline(left * rhs, is_negative);
+        return *this;
+    }
     if (*this == 0 || rhs == 0) {
         return *this = 0;
     }
-    uint32_t carry = 0;
-    for (size_t i = 0; i < value.size(); ++i) {
-        uint64_t cur = static_cast<uint64_t>(value[i]) * static_cast<uint64_t>(rhs) + carry;
-        value[i] = static_cast<uint32_t>(cur);
-        carry = static_cast<uint32_t>(cur >> std::numeric_limits<uint32_t>::digits);
-    }
-    if (carry != 0) {
-        value.push_back(carry);
+    promote();
+    if (rhs <= UINT32_MAX) {
+        uint32_t carry = mpn::mul_1(value, value, static_cast<uint32_t>(rhs));
+        if (carry != 0) {
+            value.push_back(carry);
+        }
+        return *this;
     }
+    uint32_t digits[2];
+    size_t n = value.size();
+    workspace_frame frame;
+    std::span<uint32_t> result(frame.allocate(n + 2), n + 2);
+    mpn::mul(result, value, split_limbs(rhs, digits));
+    value.assign(result.begin(), result.end());
+    skip_leading_zeros();
     return *this;
 }
 
-big_integer big_integer::mul_to_short(const big_integer& a, uint32_t rhs) {
-    return big_integer(a).mul_to_short(rhs);
-}
-
-std::pair<big_integer, big_integer> big_integer::division(const big_integer& a, const big_integer& b) {
-    uint32_t f = static_cast<uint32_t>(big_integer::RADIX / (b.value.back() + 1));
-    big_integer r = a * f;
-    big_integer d = b * f;
-    r.is_negative = false;
-    d.is_negative = false;
-    big_integer result;
-    size_t result_size = r.value.size() - d.value.size();
-    result.value = std::vector<uint32_t>(result_size + 1);
-    result.value[result_size] = 0;
-    if (r >= (d << (std::numeric_limits<uint32_t>::digits * result_size))) {
-        result.value[result_size] = 1;
-        r -= d << (std::numeric_limits<uint32_t>::digits * result_size);
-    }
-    for (size_t i = result_size; i > 0; --i) {
-        uint64_t r3 = 0;
-        if (i + b.value.size() - 1 < r.value.size()) {
-            r3 += static_cast<uint64_t>(r.value[i + b.value.size() - 1]) << std::numeric_limits<uint32_t>::digits;
+// *this += a * b, or -= with negate. Products of short operands are accumulated row by row into the limbs of
+// *this, longer ones are multiplied into scratch first. Subtracting more than *this holds wraps around
+// modulo the width of the limbs, which is undone by negating them in two's complement.
+void big_integer::add_product(const big_integer& a, const big_integer& b, bool negate) {
+    if (a == 0 || b == 0) {
+        return;
+    }
+    if (this == &a || this == &b) {
+        big_integer copy = *this;
+        add_product(this == &a ? copy : a, this == &b ? copy : b, negate);
+        return;
+    }
+    promote();
+    bool product_negative = (a.is_negative != b.is_negative) != negate;
+    if (*this == 0) {
+        value.clear();
+        is_negative = product_negative;
+    }
+    bool subtract = is_negative != product_negative;
+    std::span<const uint32_t> x = a.limbs();
+    std::span<const uint32_t> y = b.limbs();
+    if (x.size() < y.size()) {
+        std::swap(x, y);
+    }
+    size_t n = x.size();
+    size_t m = y.size();
+    value.resize(std::max(value.size(), n + m) + 1, 0);
+    std::span<uint32_t> acc = value;
+    uint32_t borrow = 0;
+    if (m < current_thresholds.add_product_rows) {
+        instrumentation::timed_operation operation(algorithm_tier::schoolbook_multiplication, n);
+        for (size_t i = 0; i < m; ++i) {
+            std::span<uint32_t> rest = acc.subspan(i + n);
+            if (subtract) {
+                borrow |= mpn::sub_1(rest, rest, mpn::submul_1(acc.subspan(i, n), x, y[i]));
+            } else {
+                mpn::add_1(rest, rest, mpn::addmul_1(acc.subspan(i, n), x, y[i]));
+            }
         }
-        if (i + b.value.size() - 1 <= r.value.size()) {
-            r3 += r.value[i + b.value.size() - 2];
+    } else {
+        workspace_frame frame;
+        std::span<uint32_t> product(frame.allocate(n + m), n + m);
+        mpn::mul(product, x, y, pool.get());
+        if (subtract) {
+            borrow = mpn::sub(acc, acc, product);
+        } else {
+            mpn::add(acc, acc, product);
         }
-        uint64_t d2 = d.value[b.value.size() - 1];
-        uint32_t trial = static_cast<uint32_t>(std::min(r3 / d2, static_cast<uint64_t>(UINT32_MAX)));
-        big_integer dq = mul_to_short(d, trial) << (std::numeric_limits<uint32_t>::digits * (i - 1));
-        if (r < dq) {
-            --trial;
-            dq = mul_to_short(d, trial) << (std::numeric_limits<uint32_t>::digits * (i - 1));
+    }
+    if (borrow != 0) {
+        for (uint32_t& digit : value) {
+            digit = ~digit;
         }
-        result.value[i - 1] = trial;
-        r -= dq;
+        mpn::add_1(acc, acc, 1);
+        is_negative = !is_negative;
+    }
+    skip_leading_zeros();
+    if (value.size() == 1 && value[0] == 0) {
+        is_negative = false;
     }
-    r.div_to_short(f);
-    r.is_negative = a.is_negative;
-    r.skip_leading_zeros();
-    result.skip_leading_zeros();
-    result.is_negative = a.is_negative != b.is_negative;
-    return {result, r};
 }
 
 big_integer& big_integer::operator/=(const big_integer& rhs) {
-    if (rhs.value.size() == 1) {
-        this->div_to_short(rhs.value[0]);
-        if (*this != 0 && rhs.is_negative) {
+    uint64_t right;
+    if (rhs.get_inline(right)) {
+        bool negate = rhs.is_negative;
+        this->div_to_short(right);
+        if (*this != 0 && negate) {
             is_negative = !is_negative;
         }
         return *this;
     }
-    if (value.size() < rhs.value.size()) {
+    if (limbs().size() < rhs.limbs().size()) {
         return *this = 0;
     }
     if (*this == 0) {
         return *this = 0;
     }
-    return *this = division(*this, rhs).first;
+    promote();
+    size_t n = value.size();
+    size_t m = rhs.limbs().size();
+    workspace_frame frame;
+    std::span<uint32_t> q(frame.allocate(n - m + 1), n - m + 1);
+    std::span<uint32_t> r(frame.allocate(m), m);
+    mpn::divrem(q, r, value, rhs.limbs());
+    value.assign(q.begin(), q.end());
+    skip_leading_zeros();
+    is_negative = is_negative != rhs.is_negative;
+    if (value.size() == 1 && value[0] == 0) {
+        is_negative = false;
+    }
+    return *this;
 }
 
 big_integer& big_integer::operator%=(const big_integer& rhs) {
-    if (rhs.value.size() == 1) {
-        return this->mod_to_short(rhs.value[0]);
+    uint64_t right;
+    if (rhs.get_inline(right)) {
+        return this->mod_to_short(right);
     }
-    if (value.size() < rhs.value.size()) {
+    if (limbs().size() < rhs.limbs().size()) {
         return *this;
     }
     if (*this == 0) {
         return *this = 0;
     }
-    return *this = division(*this, rhs).second;
+    promote();
+    size_t n = value.size();
+    size_t m = rhs.limbs().size();
+    workspace_frame frame;
+    std::span<uint32_t> q(frame.allocate(n - m + 1), n - m + 1);
+    std::span<uint32_t> r(frame.allocate(m), m);
+    mpn::divrem(q, r, value, rhs.limbs());
+    value.assign(r.begin(), r.end());
+    skip_leading_zeros();
+    if (value.size() == 1 && value[0] == 0) {
+        is_negative = false;
+    }
+    return *this;
 }
 
-big_integer& big_integer::div_to_short(uint32_t rhs) {
+big_integer& big_integer::div_to_short(uint64_t rhs) {
+    uint64_t left;
+    if (get_inline(left) && rhs != 0) {
+        set_inline(left / rhs, is_negative);
+        return *this;
+    }
     if (*this == 0) {
         return *this;
     }
-    uint32_t carry = 0;
-    for (size_t i = value.size(); i > 0; --i) {
-        uint64_t temp =
-                (static_cast<uint64_t>(carry) << std::numeric_limits<uint32_t>::digits) + static_cast<uint64_t>(value[i - 1]);
-        value[i - 1] = static_cast<uint32_t>(temp / rhs);
-        carry = static_cast<uint32_t>(temp % rhs);
+    promote();
+    if (rhs <= UINT32_MAX) {
+        mpn::divrem_1(value, value, static_cast<uint32_t>(rhs));
+    } else {
+        uint32_t digits[2];
+        size_t n = value.size();
+        workspace_frame frame;
+        std::span<uint32_t> q(frame.allocate(n - 1), n - 1);
+        std::span<uint32_t> r(frame.allocate(2), 2);
+        mpn::divrem(q, r, value, split_limbs(rhs, digits));
+        value.assign(q.begin(), q.end());
     }
     skip_leading_zeros();
     if (value.size() == 1 && value[0] == 0) {
@@ -369,77 +547,78 @@ big_integer& big_integer::div_to_short(uint32_t rhs) {
     return *this;
 }
 
-big_integer& big_integer::mod_to_short(uint32_t rhs) {
-    if (*this == 0) {
+big_integer& big_integer::mod_to_short(uint64_t rhs) {
+    uint64_t left;
+    if (get_inline(left) && rhs != 0) {
+        set_inline(left % rhs, is_negative);
         return *this;
     }
-    uint32_t carry = 0;
-    for (size_t i = value.size(); i > 0; --i) {
-        uint64_t temp =
-                (static_cast<uint64_t>(carry) << std::numeric_limits<uint32_t>::digits) + static_cast<uint64_t>(value[i - 1]);
-        carry = static_cast<uint32_t>(temp % rhs);
+    if (*this == 0) {
+        return *this;
     }
-    std::vector<uint32_t>(1, carry).swap(value);
-    if (carry == 0) {
-        is_negative = false;
+    if (rhs <= UINT32_MAX) {
+        set_inline(mpn::mod_1(limbs(), static_cast<uint32_t>(rhs)), is_negative);
+        return *this;
     }
+    uint32_t digits[2];
+    std::span<const uint32_t> a = limbs();
+    workspace_frame frame;
+    std::span<uint32_t> q(frame.allocate(a.size() - 1), a.size() - 1);
+    std::span<uint32_t> r(frame.allocate(2), 2);
+    mpn::divrem(q, r, a, split_limbs(rhs, digits));
+    set_inline(r[0] | static_cast<uint64_t>(r[1]) << std::numeric_limits<uint32_t>::digits, is_negative);
     return *this;
 }
 
-void big_integer::commutative_bitwise_operation(const big_integer& rhs,
-                                                const std::function<uint32_t(uint32_t a, uint32_t b)> binary_function) {
-assert(rhs != 0);
-assert(*this != 0);
-
-if (is_negative) {
-++*this;
-for (uint32_t& digit : value) {
-digit = ~digit;
-}
-}
-if (rhs.value.size() > value.size()) {
-value.resize(rhs.value.size(), (is_negative ? UINT32_MAX : 0));
+int big_integer::compare_to_short(uint64_t rhs, bool negative) const {
+    negative = negative && rhs != 0;
+    if (is_negative != negative) {
+        return is_negative ? -1 : 1;
+    }
+    uint64_t left;
+    int cmp = get_inline(left) ? static_cast<int>(left > rhs) - static_cast<int>(left < rhs) : 1;
+    return is_negative ? -cmp : cmp;
 }
 
-if (rhs.is_negative) {
-size_t left_border = 0;
-while (left_border < rhs.value.size() && rhs.value[left_border] == 0) {
-++left_border;
-}
-for (size_t i = 0; i < left_border; ++i) {
-value[i] = binary_function(value[i], 0);
-}
-if (left_border < rhs.value.size()) {
-value[left_border] = binary_function(value[left_border], ~(rhs.value[left_border] - 1));
-}
-for (size_t i = left_border + 1; i < value.size(); ++i) {
-if (i < rhs.value.size()) {
-value[i] = binary_function(value[i], ~rhs.value[i]);
-} else {
-value[i] = binary_function(value[i], UINT32_MAX);
-}
-}
-} else {
-for (size_t i = 0; i < value.size(); ++i) {
-if (i < rhs.value.size()) {
-value[i] = binary_function(value[i], rhs.value[i]);
-} else {
-value[i] = binary_function(value[i], 0);
-}
-}
-}
-
-is_negative = binary_function(is_negative, rhs.is_negative);
-if (is_negative) {
-for (uint32_t& digit : value) {
-digit = ~digit;
-}
---*this;
-}
-skip_leading_zeros();
+// Both operands and the result are converted to and from two's complement limb by limb, so nothing
+// but the result is stored. Reading a limb of rhs before writing the same limb keeps a op= a correct.
+void big_integer::commutative_bitwise_operation(const big_integer& rhs,
+                                                const std::function<uint32_t(uint32_t a, uint32_t b)> binary_function) {
+    bool result_negative = binary_function(is_negative, rhs.is_negative) != 0;
+    uint32_t left_mask = is_negative ? UINT32_MAX : 0;
+    uint32_t right_mask = rhs.is_negative ? UINT32_MAX : 0;
+    uint32_t result_mask = result_negative ? UINT32_MAX : 0;
+    uint64_t left_carry = left_mask & 1;
+    uint64_t right_carry = right_mask & 1;
+    uint64_t result_carry = result_mask & 1;
+    promote();
+    size_t right_size = rhs.limbs().size();
+    value.resize(std::max(value.size(), right_size), 0);
+    std::span<const uint32_t> right_digits = rhs.limbs();
+    for (size_t i = 0; i < value.size(); ++i) {
+        uint64_t left = static_cast<uint64_t>(value[i] ^ left_mask) + left_carry;
+        uint64_t right = static_cast<uint64_t>((i < right_size ? right_digits[i] : 0) ^ right_mask) + right_carry;
+        left_carry = left >> std::numeric_limits<uint32_t>::digits;
+        right_carry = right >> std::numeric_limits<uint32_t>::digits;
+        uint32_t digit = binary_function(static_cast<uint32_t>(left), static_cast<uint32_t>(right));
+        uint64_t result = static_cast<uint64_t>(digit ^ result_mask) + result_carry;
+        result_carry = result >> std::numeric_limits<uint32_t>::digits;
+        value[i] = static_cast<uint32_t>(result);
+    }
+    if (result_carry != 0) {
+        value.push_back(1);
+    }
+    is_negative = result_negative;
+    skip_leading_zeros();
 }
 
 big_integer& big_integer::operator&=(const big_integer& rhs) {
+    int64_t left;
+    int64_t right;
+    if (get_int64(left) && rhs.get_int64(right)) {
+        set_int64(left & right);
+        return *this;
+    }
     if (rhs == 0 || *this == 0) {
         return *this = 0;
     }
@@ -448,6 +627,12 @@ big_integer& big_integer::operator&=(const big_integer& rhs) {
 }
 
 big_integer& big_integer::operator|=(const big_integer& rhs) {
+    int64_t left;
+    int64_t right;
+    if (get_int64(left) && rhs.get_int64(right)) {
+        set_int64(left | right);
+        return *this;
+    }
     if (rhs == 0) {
         return *this;
     }
@@ -459,6 +644,12 @@ big_integer& big_integer::operator|=(const big_integer& rhs) {
 }
 
 big_integer& big_integer::operator^=(const big_integer& rhs) {
+    int64_t left;
+    int64_t right;
+    if (get_int64(left) && rhs.get_int64(right)) {
+        set_int64(left ^ right);
+        return *this;
+    }
     if (rhs == 0) {
         return *this;
     }
@@ -473,48 +664,57 @@ big_integer& big_integer::operator<<=(int rhs) {
     if (rhs == 0 || *this == 0) {
         return *this;
     }
-    uint32_t digits_shift = rhs / std::numeric_limits<uint32_t>::digits;
-    uint32_t shift = rhs % std::numeric_limits<uint32_t>::digits;
-    if (digits_shift > 0) {
-        value.insert(value.begin(), digits_shift, 0);
-    }
-    if (shift > 0) {
-        uint64_t carry = 0;
-        for (size_t i = digits_shift; i < value.size(); ++i) {
-            uint64_t temp = (static_cast<uint64_t>(value[i]) << shift) + carry;
-            value[i] = temp & UINT32_MAX;
-            carry = temp >> std::numeric_limits<uint32_t>::digits;
-        }
-        if (carry > 0) {
-            value.push_back(carry);
-        }
+    uint64_t left;
+    if (get_inline(left) && rhs > 0 && std::bit_width(left) + rhs <= std::numeric_limits<uint64_t>::digits) {
+        set_inline(left << rhs, is_negative);
+        return *this;
     }
+    promote();
+    size_t digits_shift = rhs / std::numeric_limits<uint32_t>::digits;
+    int shift = rhs % std::numeric_limits<uint32_t>::digits;
+    size_t size = value.size();
+    value.resize(size + digits_shift + 1);
+    value[size + digits_shift] = mpn::lshift(std::span(value.data() + digits_shift, size),
+                                             std::span(value.data(), size), shift);
+    std::fill(value.begin(), value.begin() + digits_shift, 0);
+    skip_leading_zeros();
     return *this;
 }
 
+// Rounds towards negative infinity like an arithmetic shift of the two's complement representation:
+// a negative number that loses non-zero bits is rounded away from zero.
 big_integer& big_integer::operator>>=(int rhs) {
     if (rhs == 0 || *this == 0) {
         return *this;
     }
-    uint32_t digits_shift = rhs / std::numeric_limits<uint32_t>::digits;
-    uint32_t shift = rhs % std::numeric_limits<uint32_t>::digits;
-    if (digits_shift > 0) {
-        if (digits_shift >= value.size()) {
-            return *this = 0;
-        }
-        value.erase(value.begin(), value.begin() + digits_shift);
-    }
-    if (shift > 0) {
-        uint32_t carry = 0;
-        for (size_t i = value.size(); i > 0; --i) {
-            uint32_t new_carry = value[i - 1] << (std::numeric_limits<uint32_t>::digits - shift);
-            value[i - 1] = (value[i - 1] >> shift) + carry;
-            carry = new_carry;
-        }
+    uint64_t left;
+    if (get_inline(left) && rhs > 0) {
+        bool is_short_shift = rhs < std::numeric_limits<uint64_t>::digits;
+        uint64_t result = is_short_shift ? left >> rhs : 0;
+        bool is_inexact = is_short_shift ? (left & ((uint64_t(1) << rhs) - 1)) != 0 : left != 0;
+        set_inline(is_negative && is_inexact ? result + 1 : result, is_negative);
+        return *this;
     }
+    promote();
+    size_t digits_shift = rhs / std::numeric_limits<uint32_t>::digits;
+    int shift = rhs % std::numeric_limits<uint32_t>::digits;
+    size_t size = value.size();
+    if (digits_shift >= size) {
+        return *this = is_negative ? -1 : 0;
+    }
+    bool is_inexact = std::any_of(value.begin(), value.begin() + digits_shift, [](uint32_t digit) { return digit != 0; });
+    is_inexact |= mpn::rshift(std::span(value.data(), size - digits_shift),
+                              std::span(value.data() + digits_shift, size - digits_shift), shift) != 0;
+    value.resize(size - digits_shift);
     skip_leading_zeros();
-    if (is_negative) {
-        --*this;
+    if (is_negative && is_inexact) {
+        uint32_t carry = mpn::add_1(value, value, 1);
+        if (carry != 0) {
+            value.push_back(carry);
+        }
+    }
+    if (value.size() == 1 && value[0] == 0) {
+        is_negative = false;
     }
     return *this;
 }
@@ -604,23 +804,18 @@ bool operator==(const big_integer& a, const big_integer& b) {
     if (a == 0) {
         return b == 0;
     }
-    if (a.is_negative != b.is_negative || a.value.size() != b.value.size()) {
+    if (a.is_negative != b.is_negative) {
         return false;
     }
-    for (size_t i = 0; i < a.value.size(); ++i) {
-        if (a.value[i] != b.value[i]) {
-            return false;
-        }
-    }
-    return true;
+    std::span<const uint32_t> x = a.limbs();
+    std::span<const uint32_t> y = b.limbs();
+    return std::equal(x.begin(), x.end(), y.begin(), y.end());
 }
 
 bool operator==(const big_integer& a, const int& b) {
-    if (a.value.empty()) {
-        return b == 0;
-    }
-    return a.value.size() == 1 && (b < 0) == a.is_negative &&
-           static_cast<uint32_t>(std::abs(static_cast<int64_t>(b))) == a.value[0];
+    std::span<const uint32_t> digits = a.limbs();
+    return digits.size() == 1 && (b < 0) == a.is_negative &&
+           static_cast<uint32_t>(std::abs(static_cast<int64_t>(b))) == digits[0];
 }
 
 bool operator!=(const big_integer& a, const big_integer& b) {
@@ -631,15 +826,13 @@ bool operator<(const big_integer& a, const big_integer& b) {
     if (a.is_negative != b.is_negative) {
         return a.is_negative;
     }
-    if (a.value.size() != b.value.size()) {
-        return (a.value.size() < b.value.size()) != a.is_negative;
+    std::span<const uint32_t> x = a.limbs();
+    std::span<const uint32_t> y = b.limbs();
+    if (x.size() != y.size()) {
+        return (x.size() < y.size()) != a.is_negative;
     }
-    for (size_t i = a.value.size(); i > 0; --i) {
-        if (a.value[i - 1] != b.value[i - 1]) {
-            return (a.value[i - 1] < b.value[i - 1]) != a.is_negative;
-        }
-    }
-    return false;
+    int cmp = mpn::cmp(x, y);
+    return cmp != 0 && (cmp < 0) != a.is_negative;
 }
 
 bool operator>(const big_integer& a, const big_integer& b) {
@@ -654,32 +847,357 @@ bool operator>=(const big_integer& a, const big_integer& b) {
     return !(a < b);
 }
 
-std::string to_string(const big_integer& a) {
-    if (a == 0) {
-        return "0";
+// Powers 10^(9 * 2^k) shared by the decimal conversions of the calling thread. They outlive any memory
+// scope, so they are kept on the global heap.
+const std::vector<big_integer>& big_integer::decimal_powers(size_t count) {
+    thread_local std::vector<big_integer> powers;
+    if (powers.size() < count) {
+        big_integer_memory_scope heap(std::pmr::new_delete_resource());
+        if (powers.empty()) {
+            powers.push_back(big_integer(STRING_RADIX));
+        }
+        while (powers.size() < count) {
+            powers.push_back(powers.back() * powers.back());
+        }
     }
-    big_integer cur = a;
-    cur.is_negative = false;
+    return powers;
+}
 
-    std::string result;
-    while (cur > 0) {
-        std::string temp = std::to_string((big_integer(cur).mod_to_short(big_integer::STRING_RADIX)).value[0]);
-        std::reverse(temp.begin(), temp.end());
-        temp.resize(std::numeric_limits<uint32_t>::digits10, '0');
-        result += temp;
-        cur.div_to_short(big_integer::STRING_RADIX);
+// Digits are produced by splitting the number with powers[k - 1] and writing both halves into disjoint,
+// zero-padded parts of one buffer, so the halves can be converted independently.
+void big_integer::to_decimal(std::span<const uint32_t> a, const std::vector<big_integer>& powers, size_t k,
+                             char* out, size_t width, thread_pool* workers) {
+    size_t n = a.size();
+    while (n > 0 && a[n - 1] == 0) {
+        --n;
+    }
+    workspace_frame frame;
+    if (k == 0 || n < current_thresholds.decimal_conversion) {
+        std::span<uint32_t> digits(frame.allocate(n), n);
+        std::copy(a.begin(), a.begin() + n, digits.begin());
+        size_t pos = width;
+        while (!digits.empty()) {
+            uint32_t carry = mpn::divrem_1(digits, digits, STRING_RADIX);
+            while (!digits.empty() && digits.back() == 0) {
+                digits = digits.first(digits.size() - 1);
+            }
+            for (size_t i = 0; i < STRING_RADIX_DIGITS && pos > 0; ++i) {
+                out[--pos] = static_cast<char>('0' + carry % CHAR_RADIX);
+                carry /= CHAR_RADIX;
+            }
+        }
+        return;
+    }
+    std::span<const uint32_t> divisor = powers[k - 1].limbs();
+    std::span<const uint32_t> q;
+    std::span<const uint32_t> r = a.first(n);
+    if (n >= divisor.size()) {
+        std::span<uint32_t> quotient(frame.allocate(n - divisor.size() + 1), n - divisor.size() + 1);
+        std::span<uint32_t> remainder(frame.allocate(divisor.size()), divisor.size());
+        mpn::divrem(quotient, remainder, a.first(n), divisor);
+        q = quotient;
+        r = remainder;
+    }
+    size_t half = width / 2;
+    auto high = [&] { to_decimal(q, powers, k - 1, out, width - half, workers); };
+    auto low = [&] { to_decimal(r, powers, k - 1, out + width - half, half, workers); };
+    if (workers != nullptr && n >= current_options.conversion_cutoff) {
+        task_group group(*workers);
+        group.run(high);
+        low();
+        group.wait();
+    } else {
+        high();
+        low();
     }
+}
 
-    while (result.size() > 1 && result.back() == '0') {
-        result.pop_back();
+// Like to_decimal, but the halves are written one after the other to sink once they fit into a chunk,
+// keeping only the quotients and remainders of the current path in scratch. Leading zeros are dropped
+// until the first non-zero digit has been written.
+void big_integer::stream_decimal(std::span<const uint32_t> a, const std::vector<big_integer>& powers, size_t k,
+                                 size_t width, bool& leading, const std::function<void(std::string_view)>& sink) {
+    if (k == 0 || width <= STREAM_CHUNK_DIGITS) {
+        std::string chunk(width, '0');
+        to_decimal(a, powers, k, chunk.data(), width, pool.get());
+        std::string_view digits = chunk;
+        if (leading) {
+            size_t first = digits.find_first_not_of('0');
+            digits = digits.substr(std::min(first, digits.size()));
+            leading = digits.empty();
+        }
+        if (!digits.empty()) {
+            sink(digits);
+        }
+        return;
+    }
+    size_t n = a.size();
+    while (n > 0 && a[n - 1] == 0) {
+        --n;
+    }
+    workspace_frame frame;
+    std::span<const uint32_t> divisor = powers[k - 1].limbs();
+    std::span<const uint32_t> q;
+    std::span<const uint32_t> r = a.first(n);
+    if (n >= divisor.size()) {
+        std::span<uint32_t> quotient(frame.allocate(n - divisor.size() + 1), n - divisor.size() + 1);
+        std::span<uint32_t> remainder(frame.allocate(divisor.size()), divisor.size());
+        mpn::divrem(quotient, remainder, a.first(n), divisor);
+        q = quotient;
+        r = remainder;
+    }
+    size_t half = width / 2;
+    stream_decimal(q, powers, k - 1, width - half, leading, sink);
+    stream_decimal(r, powers, k - 1, half, leading, sink);
+}
+
+// out = the number written with digits[0, length), for at least one limb of out per 9 digits.
+// The halves are parsed into scratch limbs of the calling thread and combined as high * 10^low_length + low.
+void big_integer::from_decimal(const char* digits, size_t length, const std::vector<big_integer>& powers,
+                               std::span<uint32_t> out, thread_pool* workers) {
+    std::fill(out.begin(), out.end(), 0);
+    size_t k = powers.size();
+    while (k > 0 && (STRING_RADIX_DIGITS << (k - 1)) >= length) {
+        --k;
+    }
+    if (k == 0 || length <= current_thresholds.decimal_conversion * STRING_RADIX_DIGITS) {
+        size_t size = 0;
+        uint32_t cur_digit = 0;
+        uint32_t cur_radix = 1;
+        for (size_t i = 0; i < length; ++i) {
+            cur_digit = cur_digit * CHAR_RADIX + (digits[i] - '0');
+            cur_radix *= CHAR_RADIX;
+            if (cur_radix == STRING_RADIX || i + 1 == length) {
+                std::span<uint32_t> result = out.first(size);
+                uint32_t carry = mpn::mul_1(result, result, cur_radix);
+                carry += mpn::add_1(result, result, cur_digit);
+                if (carry != 0) {
+                    out[size++] = carry;
+                }
+                cur_digit = 0;
+                cur_radix = 1;
+            }
+        }
+        return;
+    }
+    size_t low_length = STRING_RADIX_DIGITS << (k - 1);
+    size_t high_length = length - low_length;
+    size_t low_limbs = size_t(1) << (k - 1);
+    size_t high_limbs = (high_length + STRING_RADIX_DIGITS - 1) / STRING_RADIX_DIGITS;
+    workspace_frame frame;
+    std::span<uint32_t> high(frame.allocate(high_limbs), high_limbs);
+    std::span<uint32_t> low(frame.allocate(low_limbs), low_limbs);
+    auto parse_high = [&] { from_decimal(digits, high_length, powers, high, workers); };
+    auto parse_low = [&] { from_decimal(digits + high_length, low_length, powers, low, workers); };
+    if (workers != nullptr && length >= current_options.conversion_cutoff * STRING_RADIX_DIGITS) {
+        task_group group(*workers);
+        group.run(parse_high);
+        parse_low();
+        group.wait();
+    } else {
+        parse_high();
+        parse_low();
+    }
+    while (!high.empty() && high.back() == 0) {
+        high = high.first(high.size() - 1);
+    }
+    std::span<const uint32_t> power = powers[k - 1].limbs();
+    if (!high.empty()) {
+        mpn::mul(out.first(high.size() + power.size()), high, power, workers);
+    }
+    mpn::add(out, out, low);
+}
+
+void addmul(big_integer& acc, const big_integer& a, const big_integer& b) {
+    acc.add_product(a, b, false);
+}
+
+void submul(big_integer& acc, const big_integer& a, const big_integer& b) {
+    acc.add_product(a, b, true);
+}
+
+big_integer mulmod(const big_integer& a, const big_integer& b, const big_integer& m) {
+    if (m == 0) {
+        throw std::invalid_argument("Division by zero");
+    }
+    big_integer result;
+    if (a == 0 || b == 0) {
+        return result = 0;
+    }
+    std::span<const uint32_t> modulus = m.limbs();
+    workspace_frame frame;
+    size_t size = a.limbs().size() + b.limbs().size();
+    std::span<uint32_t> product(frame.allocate(size), size);
+    mpn::mul(product, a.limbs(), b.limbs(), pool.get());
+    while (product.size() > 1 && product.back() == 0) {
+        product = product.first(product.size() - 1);
+    }
+    if (product.size() < modulus.size()) {
+        result.value.assign(product.begin(), product.end());
+    } else {
+        size_t q_size = product.size() - modulus.size() + 1;
+        std::span<uint32_t> q(frame.allocate(q_size), q_size);
+        std::span<uint32_t> r(frame.allocate(modulus.size()), modulus.size());
+        mpn::divrem(q, r, product, modulus);
+        result.value.assign(r.begin(), r.end());
+    }
+    result.skip_leading_zeros();
+    result.is_negative = a.is_negative != b.is_negative && !(result.value.size() == 1 && result.value[0] == 0);
+    return result;
+}
+
+big_integer operator*(const big_integer_view& a, const big_integer_view& b) {
+    big_integer result;
+    if (a.limbs().empty() || b.limbs().empty()) {
+        return result;
+    }
+    result.value.resize(a.limbs().size() + b.limbs().size());
+    mpn::mul(result.value, a.limbs(), b.limbs(), pool.get());
+    result.skip_leading_zeros();
+    result.is_negative = a.is_negative() != b.is_negative();
+    return result;
+}
+
+big_integer operator/(const big_integer_view& a, const big_integer_view& b) {
+    big_integer quotient;
+    big_integer::div_mod(a, b, &quotient, nullptr);
+    return quotient;
+}
+
+big_integer operator%(const big_integer_view& a, const big_integer_view& b) {
+    big_integer remainder;
+    big_integer::div_mod(a, b, nullptr, &remainder);
+    return remainder;
+}
+
+void big_integer::div_mod(const big_integer_view& a, const big_integer_view& b, big_integer* quotient,
+                          big_integer* remainder) {
+    std::span<const uint32_t> x = a.limbs();
+    std::span<const uint32_t> y = b.limbs();
+    if (y.empty()) {
+        throw std::invalid_argument("Division by zero");
+    }
+    if (x.size() < y.size()) {
+        if (remainder != nullptr) {
+            *remainder = static_cast<big_integer>(a);
+        }
+        return;
+    }
+    workspace_frame frame;
+    std::span<uint32_t> q(frame.allocate(x.size() - y.size() + 1), x.size() - y.size() + 1);
+    std::span<uint32_t> r(frame.allocate(y.size()), y.size());
+    mpn::divrem(q, r, x, y);
+    if (quotient != nullptr) {
+        quotient->assign_limbs(q);
+        quotient->is_negative = *quotient != 0 && a.is_negative() != b.is_negative();
     }
-    if (a.is_negative) {
-        result += '-';
+    if (remainder != nullptr) {
+        remainder->assign_limbs(r);
+        remainder->is_negative = *remainder != 0 && a.is_negative();
     }
-    std::reverse(result.begin(), result.end());
+}
+
+std::string to_string(const big_integer& a) {
+    return to_string(big_integer_view(a));
+}
+
+std::string to_string(const big_integer_view& a) {
+    std::span<const uint32_t> digits = a.limbs();
+    if (digits.empty()) {
+        return "0";
+    }
+    bool split = digits.size() >= current_thresholds.decimal_conversion;
+    instrumentation::timed_operation operation(
+        split ? algorithm_tier::subquadratic_conversion : algorithm_tier::quadratic_conversion, digits.size());
+    size_t k = 0;
+    size_t width = digits.size() * (STRING_RADIX_DIGITS + 1);
+    if (split) {
+        while (big_integer::decimal_powers(k + 1)[k].limbs().size() <= digits.size()) {
+            ++k;
+        }
+        width = STRING_RADIX_DIGITS << k;
+    }
+    std::string result(width + 1, '0');
+    big_integer::to_decimal(digits, big_integer::decimal_powers(k), k, result.data() + 1, width, pool.get());
+
+    size_t first = result.find_first_not_of('0', 1);
+    if (a.is_negative()) {
+        result[--first] = '-';
+    }
+    result.erase(0, first);
     return result;
 }
 
+void write_decimal(const big_integer& a, const std::function<void(std::string_view)>& sink) {
+    write_decimal(big_integer_view(a), sink);
+}
+
+void write_decimal(const big_integer_view& a, const std::function<void(std::string_view)>& sink) {
+    std::span<const uint32_t> digits = a.limbs();
+    if (digits.empty()) {
+        sink("0");
+        return;
+    }
+    if (a.is_negative()) {
+        sink("-");
+    }
+    size_t k = 0;
+    size_t width = digits.size() * (STRING_RADIX_DIGITS + 1);
+    if (digits.size() >= current_thresholds.decimal_conversion) {
+        while (big_integer::decimal_powers(k + 1)[k].limbs().size() <= digits.size()) {
+            ++k;
+        }
+        width = STRING_RADIX_DIGITS << k;
+    }
+    bool leading = true;
+    big_integer::stream_decimal(digits, big_integer::decimal_powers(k), k, width, leading, sink);
+}
+
+// Padding to a field width needs the length of the text up front.
 std::ostream& operator<<(std::ostream& out, const big_integer& a) {
-    return out << to_string(a);
-}
\ No newline at end of file
+    return out << big_integer_view(a);
+}
+
+std::ostream& operator<<(std::ostream& out, const big_integer_view& a) {
+    if (out.width() != 0) {
+        return out << to_string(a);
+    }
+    write_decimal(a, [&out](std::string_view digits) { out.write(digits.data(), digits.size()); });
+    return out;
+}
+
+void set_parallel_options(const parallel_options& options) {
+    pool.reset();
+    current_options = options;
+    if (current_options.threads == 0) {
+        current_options.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (current_options.threads > 1) {
+        pool = std::make_unique<thread_pool>(current_options.threads);
+    }
+}
+
+thread_pool* big_integer::workers() {
+    return pool.get();
+}
+
+parallel_options get_parallel_options() {
+    return current_options;
+}
+
+void set_algorithm_thresholds(const algorithm_thresholds& thresholds) {
+    if (thresholds.karatsuba_multiplication < 4 || thresholds.karatsuba_square < 4) {
+        throw std::invalid_argument("Karatsuba threshold must be at least 4");
+    }
+    if (thresholds.decimal_conversion < 1) {
+        throw std::invalid_argument("Decimal conversion threshold must be at least 1");
+    }
+    if (thresholds.half_gcd < 2) {
+        throw std::invalid_argument("Half-GCD threshold must be at least 2");
+    }
+    current_thresholds = thresholds;
+}
+
+algorithm_thresholds get_algorithm_thresholds() {
+    return current_thresholds;
+}
@@ -1,12 +1,87 @@
 #pragma once
 
+#include <array>
+#include <compare>
+#include <concepts>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <iosfwd>
 #include <limits>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
 #include <vector>
 
+struct parallel_options {
+    // Total number of threads including the calling one: 1 keeps every operation sequential,
+    // 0 means std::thread::hardware_concurrency().
+    size_t threads = 1;
+    // Karatsuba subproducts whose shorter operand has fewer limbs than this run inline.
+    size_t multiplication_cutoff = 1024;
+    // Decimal conversions of numbers with at least this many limbs convert their halves as separate tasks.
+    size_t conversion_cutoff = 2048;
+};
+
+// Operand sizes in limbs at which the asymptotically faster algorithms take over. The values in effect at
+// startup come from tuned_thresholds.h, which the tune target regenerates for the host machine.
+struct algorithm_thresholds {
+    // Products whose shorter operand has fewer limbs than this use schoolbook multiplication, larger ones
+    // Karatsuba. At least 4.
+    size_t karatsuba_multiplication = 48;
+    // The same for squares. At least 4.
+    size_t karatsuba_square = 64;
+    // addmul and submul whose shorter operand has fewer limbs than this accumulate row by row instead of
+    // forming the product in scratch first.
+    size_t add_product_rows = 48;
+    // Decimal conversions of numbers with fewer limbs than this run in quadratic time instead of splitting
+    // by powers of 10. At least 1.
+    size_t decimal_conversion = 64;
+    // gcd, xgcd and mod_inverse of operands with fewer limbs than this run Lehmer's algorithm throughout,
+    // larger ones reduce their operands to half the size by the recursive half-GCD first. At least 2.
+    size_t half_gcd = 1024;
+};
+
+struct thread_pool;
+
+// Limbs of every big_integer created on the calling thread, including copies, are allocated from this
+// resource. Without an active big_integer_memory_scope it is std::pmr::get_default_resource().
+std::pmr::memory_resource* big_integer_memory_resource();
+
+// Makes `resource` the current one for the calling thread until the scope ends. Numbers allocated
+// from it must be destroyed before the resource, e.g. a std::pmr::monotonic_buffer_resource that
+// backs a whole computation. Pool threads always use the default resource, so the resource doesn't
+// have to be thread-safe.
+struct big_integer_memory_scope {
+public:
+    explicit big_integer_memory_scope(std::pmr::memory_resource* resource);
+    big_integer_memory_scope(const big_integer_memory_scope& other) = delete;
+    ~big_integer_memory_scope();
+
+    big_integer_memory_scope& operator=(const big_integer_memory_scope& other) = delete;
+
+private:
+    std::pmr::memory_resource* previous;
+};
+
+// Built-in integers that mixed operations take directly, without converting them to a big_integer first.
+template <typename T>
+concept native_integer = std::integral<T> && sizeof(T) <= sizeof(uint64_t);
+
+struct big_integer;
+struct big_integer_view;
+
+namespace big_integer_literals {
+
+template <char... Digits>
+big_integer operator""_bi();
+
+} // namespace big_integer_literals
+
 struct big_integer {
 public:
     big_integer();
@@ -21,6 +96,8 @@ public:
     ~big_integer();
 
     big_integer& operator=(const big_integer& other);
+    template <native_integer T>
+    big_integer& operator=(T other);
 
     big_integer& operator+=(const big_integer& rhs);
     big_integer& operator-=(const big_integer& rhs);
@@ -32,6 +109,24 @@ public:
     big_integer& operator|=(const big_integer& rhs);
     big_integer& operator^=(const big_integer& rhs);
 
+    template <native_integer T>
+    big_integer& operator+=(T rhs);
+    template <native_integer T>
+    big_integer& operator-=(T rhs);
+    template <native_integer T>
+    big_integer& operator*=(T rhs);
+    template <native_integer T>
+    big_integer& operator/=(T rhs);
+    template <native_integer T>
+    big_integer& operator%=(T rhs);
+
+    template <native_integer T>
+    big_integer& operator&=(T rhs);
+    template <native_integer T>
+    big_integer& operator|=(T rhs);
+    template <native_integer T>
+    big_integer& operator^=(T rhs);
+
     big_integer& operator<<=(int rhs);
     big_integer& operator>>=(int rhs);
 
@@ -52,33 +147,100 @@ public:
     friend bool operator<=(const big_integer& a, const big_integer& b);
     friend bool operator>=(const big_integer& a, const big_integer& b);
     friend bool operator==(const big_integer& a, const int& b);
+    template <native_integer T>
+    friend bool operator==(const big_integer& a, T b);
+    template <native_integer T>
+    friend std::strong_ordering operator<=>(const big_integer& a, T b);
 
     friend std::string to_string(const big_integer& a);
+    friend void write_decimal(const big_integer& a, const std::function<void(std::string_view)>& sink);
+    friend big_integer operator*(const big_integer_view& a, const big_integer_view& b);
+    friend big_integer operator/(const big_integer_view& a, const big_integer_view& b);
+    friend big_integer operator%(const big_integer_view& a, const big_integer_view& b);
+    friend std::string to_string(const big_integer_view& a);
+    friend void write_decimal(const big_integer_view& a, const std::function<void(std::string_view)>& sink);
+
+    friend void addmul(big_integer& acc, const big_integer& a, const big_integer& b);
+    friend void submul(big_integer& acc, const big_integer& a, const big_integer& b);
+    friend big_integer mulmod(const big_integer& a, const big_integer& b, const big_integer& m);
+
+    friend big_integer gcd(const big_integer& a, const big_integer& b);
+    friend std::tuple<big_integer, big_integer, big_integer> xgcd(const big_integer& a, const big_integer& b);
+    friend big_integer isqrt(const big_integer& a);
+    friend big_integer iroot(const big_integer& a, uint32_t k);
+    friend bool is_perfect_square(const big_integer& a);
+    friend std::vector<big_integer> batch_gcd(const std::vector<big_integer>& moduli);
 
 private:
     static const uint32_t STRING_RADIX = 1'000'000'000;
     static const uint32_t CHAR_RADIX = 10;
     static const uint64_t RADIX = 1ull << std::numeric_limits<uint32_t>::digits;
 
-    std::vector<uint32_t> value;
+    // Magnitudes of up to 64 bits are kept in inline_value without allocating while value is empty.
+    // Arithmetic on such numbers uses native operations and moves to value only when a result overflows.
+    std::pmr::vector<uint32_t> value;
+    uint32_t inline_value[2] = {0, 0};
     bool is_negative = false;
 
-    void skip_leading_zeros();
+    std::span<const uint32_t> limbs() const;
+    bool get_inline(uint64_t& magnitude) const;
+    bool get_int64(int64_t& result) const;
+    void set_inline(uint64_t magnitude, bool negative);
+    void set_int64(int64_t a);
+    bool add_inline(uint64_t magnitude, bool negative);
+    void promote();
+    void assign_limbs(std::span<const uint32_t> digits);
 
-    std::pair<big_integer, big_integer> division(const big_integer& a, const big_integer& b);
+    void skip_leading_zeros();
+    size_t bit_length() const;
 
     void commutative_bitwise_operation(const big_integer& rhs,
                                        const std::function<uint32_t(uint32_t a, uint32_t b)> binary_function);
 
-    big_integer& mul_to_short(uint32_t rhs);
-    big_integer& add_to_short(uint32_t rhs);
-    big_integer& sub_to_short(uint32_t rhs);
-    big_integer& div_to_short(uint32_t rhs);
-    big_integer& mod_to_short(uint32_t rhs);
+    big_integer& mul_to_short(uint64_t rhs);
+    big_integer& add_to_short(uint64_t rhs);
+    big_integer& sub_to_short(uint64_t rhs);
+    big_integer& div_to_short(uint64_t rhs);
+    big_integer& mod_to_short(uint64_t rhs);
+    int compare_to_short(uint64_t rhs, bool negative) const;
+
+    template <native_integer T>
+    static uint64_t magnitude(T a) {
+        return std::cmp_less(a, 0) ? 0 - static_cast<uint64_t>(a) : static_cast<uint64_t>(a);
+    }
+
+    void add_product(const big_integer& a, const big_integer& b, bool negate);
 
     void swap(big_integer& other);
 
-    static big_integer mul_to_short(const big_integer& a, uint32_t rhs);
+    // The pool of the parallel options, null while they are sequential.
+    static thread_pool* workers();
+
+    // Truncating division of views into whichever of quotient and remainder is not null.
+    static void div_mod(const big_integer_view& a, const big_integer_view& b, big_integer* quotient,
+                        big_integer* remainder);
+
+    static const std::vector<big_integer>& decimal_powers(size_t count);
+    static void to_decimal(std::span<const uint32_t> a, const std::vector<big_integer>& powers, size_t k, char* out,
+                           size_t width, thread_pool* workers);
+    static void stream_decimal(std::span<const uint32_t> a, const std::vector<big_integer>& powers, size_t k,
+                               size_t width, bool& leading, const std::function<void(std::string_view)>& sink);
+    static void from_decimal(const char* digits, size_t length, const std::vector<big_integer>& powers,
+                             std::span<uint32_t> out, thread_pool* workers);
+
+    template <size_t Limbs, size_t Length>
+    static constexpr std::array<uint32_t, Limbs> parse_literal(const std::array<char, Length>& chars);
+
+    template <char... Digits>
+    friend big_integer big_integer_literals::operator""_bi();
+
+    friend struct modular_context;
+    friend struct half_gcd;
+    friend struct big_integer_batch;
+    friend struct big_accumulator;
+    friend struct big_integer_view;
+    template <size_t Bits, bool Signed>
+    friend struct fixed_integer;
 };
 
 big_integer operator+(const big_integer& a, const big_integer& b);
@@ -102,5 +264,239 @@ bool operator<=(const big_integer& a, const big_integer& b);
 bool operator>=(const big_integer& a, const big_integer& b);
 bool operator==(const big_integer& a, const int& b);
 
+template <native_integer T>
+big_integer& big_integer::operator=(T other) {
+    set_inline(magnitude(other), std::cmp_less(other, 0));
+    return *this;
+}
+
+template <native_integer T>
+big_integer& big_integer::operator+=(T rhs) {
+    return std::cmp_less(rhs, 0) ? sub_to_short(magnitude(rhs)) : add_to_short(magnitude(rhs));
+}
+
+template <native_integer T>
+big_integer& big_integer::operator-=(T rhs) {
+    return std::cmp_less(rhs, 0) ? add_to_short(magnitude(rhs)) : sub_to_short(magnitude(rhs));
+}
+
+template <native_integer T>
+big_integer& big_integer::operator*=(T rhs) {
+    mul_to_short(magnitude(rhs));
+    if (std::cmp_less(rhs, 0) && *this != 0) {
+        is_negative = !is_negative;
+    }
+    return *this;
+}
+
+template <native_integer T>
+big_integer& big_integer::operator/=(T rhs) {
+    div_to_short(magnitude(rhs));
+    if (std::cmp_less(rhs, 0) && *this != 0) {
+        is_negative = !is_negative;
+    }
+    return *this;
+}
+
+template <native_integer T>
+big_integer& big_integer::operator%=(T rhs) {
+    return mod_to_short(magnitude(rhs));
+}
+
+template <native_integer T>
+big_integer& big_integer::operator&=(T rhs) {
+    int64_t left;
+    if (std::in_range<int64_t>(rhs) && get_int64(left)) {
+        set_int64(left & static_cast<int64_t>(rhs));
+        return *this;
+    }
+    return *this &= big_integer(rhs);
+}
+
+template <native_integer T>
+big_integer& big_integer::operator|=(T rhs) {
+    int64_t left;
+    if (std::in_range<int64_t>(rhs) && get_int64(left)) {
+        set_int64(left | static_cast<int64_t>(rhs));
+        return *this;
+    }
+    return *this |= big_integer(rhs);
+}
+
+template <native_integer T>
+big_integer& big_integer::operator^=(T rhs) {
+    int64_t left;
+    if (std::in_range<int64_t>(rhs) && get_int64(left)) {
+        set_int64(left ^ static_cast<int64_t>(rhs));
+        return *this;
+    }
+    return *this ^= big_integer(rhs);
+}
+
+template <native_integer T>
+big_integer operator+(const big_integer& a, T b) {
+    return big_integer(a) += b;
+}
+
+template <native_integer T>
+big_integer operator+(T a, const big_integer& b) {
+    return big_integer(b) += a;
+}
+
+template <native_integer T>
+big_integer operator-(const big_integer& a, T b) {
+    return big_integer(a) -= b;
+}
+
+template <native_integer T>
+big_integer operator-(T a, const big_integer& b) {
+    return big_integer(a) -= b;
+}
+
+template <native_integer T>
+big_integer operator*(const big_integer& a, T b) {
+    return big_integer(a) *= b;
+}
+
+template <native_integer T>
+big_integer operator*(T a, const big_integer& b) {
+    return big_integer(b) *= a;
+}
+
+template <native_integer T>
+big_integer operator/(const big_integer& a, T b) {
+    return big_integer(a) /= b;
+}
+
+template <native_integer T>
+big_integer operator/(T a, const big_integer& b) {
+    return big_integer(a) /= b;
+}
+
+template <native_integer T>
+big_integer operator%(const big_integer& a, T b) {
+    return big_integer(a) %= b;
+}
+
+template <native_integer T>
+big_integer operator%(T a, const big_integer& b) {
+    return big_integer(a) %= b;
+}
+
+template <native_integer T>
+big_integer operator&(const big_integer& a, T b) {
+    return big_integer(a) &= b;
+}
+
+template <native_integer T>
+big_integer operator&(T a, const big_integer& b) {
+    return big_integer(b) &= a;
+}
+
+template <native_integer T>
+big_integer operator|(const big_integer& a, T b) {
+    return big_integer(a) |= b;
+}
+
+template <native_integer T>
+big_integer operator|(T a, const big_integer& b) {
+    return big_integer(b) |= a;
+}
+
+template <native_integer T>
+big_integer operator^(const big_integer& a, T b) {
+    return big_integer(a) ^= b;
+}
+
+template <native_integer T>
+big_integer operator^(T a, const big_integer& b) {
+    return big_integer(b) ^= a;
+}
+
+// The reversed and the relational comparisons are rewritten from these two.
+template <native_integer T>
+bool operator==(const big_integer& a, T b) {
+    return a.compare_to_short(big_integer::magnitude(b), std::cmp_less(b, 0)) == 0;
+}
+
+template <native_integer T>
+std::strong_ordering operator<=>(const big_integer& a, T b) {
+    return a.compare_to_short(big_integer::magnitude(b), std::cmp_less(b, 0)) <=> 0;
+}
+
+// acc += a * b and acc -= a * b, accumulating the product straight into the limbs of acc.
+void addmul(big_integer& acc, const big_integer& a, const big_integer& b);
+void submul(big_integer& acc, const big_integer& a, const big_integer& b);
+// a * b % m with the sign of a * b like operator%, keeping the product in scratch limbs.
+big_integer mulmod(const big_integer& a, const big_integer& b, const big_integer& m);
+
 std::string to_string(const big_integer& a);
-std::ostream& operator<<(std::ostream& out, const big_integer& a);
\ No newline at end of file
+// Passes the decimal digits of a to sink in order, in pieces of bounded size, so that only scratch limbs
+// proportional to a are needed instead of the whole text.
+void write_decimal(const big_integer& a, const std::function<void(std::string_view)>& sink);
+// Streams through write_decimal unless a field width is set.
+std::ostream& operator<<(std::ostream& out, const big_integer& a);
+
+// Not thread-safe: must not be called while another thread performs arithmetic.
+void set_parallel_options(const parallel_options& options);
+parallel_options get_parallel_options();
+// Not thread-safe either; throws std::invalid_argument for thresholds below their minimum.
+void set_algorithm_thresholds(const algorithm_thresholds& thresholds);
+algorithm_thresholds get_algorithm_thresholds();
+
+// Little-endian limbs of the characters of an integer literal in any base, with digit separators.
+// Anything else fails constant evaluation.
+template <size_t Limbs, size_t Length>
+constexpr std::array<uint32_t, Limbs> big_integer::parse_literal(const std::array<char, Length>& chars) {
+    uint32_t base = CHAR_RADIX;
+    size_t i = 0;
+    if (Length > 1 && chars[0] == '0') {
+        if (chars[1] == 'x' || chars[1] == 'X') {
+            base = 16;
+            i = 2;
+        } else if (chars[1] == 'b' || chars[1] == 'B') {
+            base = 2;
+            i = 2;
+        } else {
+            base = 8;
+            i = 1;
+        }
+    }
+    std::array<uint32_t, Limbs> result{};
+    for (; i < Length; ++i) {
+        char c = chars[i];
+        if (c == '\'') {
+            continue;
+        }
+        uint32_t digit = c >= '0' && c <= '9'   ? c - '0'
+                         : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                         : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                                                : base;
+        if (digit >= base) {
+            throw std::invalid_argument("Literal is not an integer");
+        }
+        uint64_t carry = digit;
+        for (uint32_t& limb : result) {
+            uint64_t cur = static_cast<uint64_t>(limb) * base + carry;
+            limb = static_cast<uint32_t>(cur);
+            carry = cur >> std::numeric_limits<uint32_t>::digits;
+        }
+    }
+    return result;
+}
+
+namespace big_integer_literals {
+
+// Integer literals of any length, e.g. 0xffff'ffff'ffff'ffff'ffff_bi. The digits are parsed at compile time
+// into a static table of limbs, so creating the number only copies them.
+template <char... Digits>
+big_integer operator""_bi() {
+    static constexpr std::array<char, sizeof...(Digits)> chars = {Digits...};
+    static constexpr std::array<uint32_t, sizeof...(Digits) / 8 + 1> limbs =
+            big_integer::parse_literal<sizeof...(Digits) / 8 + 1>(chars);
+    big_integer result;
+    result.assign_limbs(limbs);
+    return result;
+}
+
+} // namespace big_integer_literals
@@ -0,0 +1,281 @@
+#include "big_integer_batch.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+
+big_integer_batch::big_integer_batch(size_t count, size_t limbs)
+        : count(count), width(limbs), data(count * limbs, 0), signs((count + BLOCK - 1) / BLOCK, 0) {
+    if (limbs == 0) {
+        throw std::invalid_argument("Batch width must be positive");
+    }
+}
+
+big_integer_batch::big_integer_batch(const std::vector<big_integer>& values, size_t limbs)
+        : big_integer_batch(values.size(), limbs) {
+    for (size_t i = 0; i < values.size(); ++i) {
+        set(i, values[i]);
+    }
+}
+
+big_integer_batch::big_integer_batch(const big_integer_batch& other) = default;
+
+big_integer_batch::~big_integer_batch() = default;
+
+big_integer_batch& big_integer_batch::operator=(const big_integer_batch& other) = default;
+
+size_t big_integer_batch::size() const {
+    return count;
+}
+
+size_t big_integer_batch::limbs() const {
+    return width;
+}
+
+big_integer big_integer_batch::get(size_t i) const {
+    big_integer result;
+    result.value.resize(width);
+    for (size_t j = 0; j < width; ++j) {
+        result.value[j] = data[j * count + i];
+    }
+    result.skip_leading_zeros();
+    result.is_negative = ((signs[i / BLOCK] >> (i % BLOCK)) & 1) != 0 && result != 0;
+    return result;
+}
+
+void big_integer_batch::set(size_t i, const big_integer& a) {
+    std::span<const uint32_t> digits = a.limbs();
+    size_t size = digits.size();
+    while (size > 0 && digits[size - 1] == 0) {
+        --size;
+    }
+    if (size > width) {
+        throw std::overflow_error("Number doesn't fit into the batch width");
+    }
+    for (size_t j = 0; j < width; ++j) {
+        data[j * count + i] = j < size ? digits[j] : 0;
+    }
+    uint64_t bit = uint64_t(1) << (i % BLOCK);
+    if (a.is_negative && size > 0) {
+        signs[i / BLOCK] |= bit;
+    } else {
+        signs[i / BLOCK] &= ~bit;
+    }
+}
+
+std::vector<big_integer> big_integer_batch::to_vector() const {
+    std::vector<big_integer> result(count);
+    for (size_t i = 0; i < count; ++i) {
+        result[i] = get(i);
+    }
+    return result;
+}
+
+uint32_t big_integer_batch::limb(size_t j, size_t i) const {
+    return j < width ? data[j * count + i] : 0;
+}
+
+uint64_t big_integer_batch::sign_block(size_t first) const {
+    return signs[first / BLOCK];
+}
+
+void big_integer_batch::set_sign_block(size_t first, uint64_t block) {
+    signs[first / BLOCK] = block;
+}
+
+void big_integer_batch::check_sizes(const big_integer_batch& result, const big_integer_batch& a,
+                                    const big_integer_batch& b) {
+    if (a.count != b.count || result.count != a.count) {
+        throw std::invalid_argument("Batches have different sizes");
+    }
+}
+
+void big_integer_batch::add(big_integer_batch& result, const big_integer_batch& a, const big_integer_batch& b) {
+    add_or_sub(result, a, b, false);
+}
+
+void big_integer_batch::sub(big_integer_batch& result, const big_integer_batch& a, const big_integer_batch& b) {
+    add_or_sub(result, a, b, true);
+}
+
+// Magnitudes with different signs are subtracted as a + ~b + 1 in the same carry chain that adds the
+// others, so every element runs the same branch-free code. A missing final carry means |a| < |b|,
+// and such elements are negated in a second pass.
+void big_integer_batch::add_or_sub(big_integer_batch& result, const big_integer_batch& a,
+                                   const big_integer_batch& b, bool negate_b) {
+    check_sizes(result, a, b);
+    size_t length = std::max({result.width, a.width, b.width}) + 1;
+    std::vector<uint32_t> sum(length * BLOCK);
+    std::vector<uint32_t> data(result.data.size());
+    std::vector<uint64_t> signs(result.signs.size());
+    uint32_t differ_mask[BLOCK];
+    uint32_t negate_mask[BLOCK];
+    uint64_t carry[BLOCK];
+    uint32_t non_zero[BLOCK];
+    bool overflow = false;
+    for (size_t first = 0; first < a.count; first += BLOCK) {
+        size_t block = std::min(BLOCK, a.count - first);
+        uint64_t a_signs = a.sign_block(first);
+        uint64_t b_signs = b.sign_block(first) ^ (negate_b ? ~uint64_t(0) : 0);
+        for (size_t i = 0; i < block; ++i) {
+            uint32_t differ = static_cast<uint32_t>(((a_signs ^ b_signs) >> i) & 1);
+            differ_mask[i] = 0 - differ;
+            carry[i] = differ;
+            non_zero[i] = 0;
+        }
+        for (size_t j = 0; j < length; ++j) {
+            const uint32_t* x = j < a.width ? &a.data[j * a.count + first] : nullptr;
+            const uint32_t* y = j < b.width ? &b.data[j * b.count + first] : nullptr;
+            uint32_t* out = &sum[j * BLOCK];
+            for (size_t i = 0; i < block; ++i) {
+                uint64_t cur = static_cast<uint64_t>(x != nullptr ? x[i] : 0) +
+                               ((y != nullptr ? y[i] : 0) ^ differ_mask[i]) + carry[i];
+                out[i] = static_cast<uint32_t>(cur);
+                carry[i] = cur >> std::numeric_limits<uint32_t>::digits;
+            }
+        }
+        for (size_t i = 0; i < block; ++i) {
+            negate_mask[i] = differ_mask[i] & (0 - static_cast<uint32_t>(carry[i] ^ 1));
+            carry[i] = negate_mask[i] & 1;
+        }
+        for (size_t j = 0; j < length; ++j) {
+            uint32_t* out = &sum[j * BLOCK];
+            for (size_t i = 0; i < block; ++i) {
+                uint64_t cur = static_cast<uint64_t>(out[i] ^ negate_mask[i]) + carry[i];
+                out[i] = static_cast<uint32_t>(cur);
+                carry[i] = cur >> std::numeric_limits<uint32_t>::digits;
+                non_zero[i] |= out[i];
+                if (j >= result.width) {
+                    overflow |= out[i] != 0;
+                }
+            }
+        }
+        if (overflow) {
+            throw std::overflow_error("Result doesn't fit into the batch width");
+        }
+        for (size_t j = 0; j < result.width; ++j) {
+            std::copy(&sum[j * BLOCK], &sum[j * BLOCK] + block, &data[j * result.count + first]);
+        }
+        uint64_t result_signs = 0;
+        for (size_t i = 0; i < block; ++i) {
+            uint64_t sign = negate_mask[i] != 0 ? (b_signs >> i) & 1 : (a_signs >> i) & 1;
+            result_signs |= (non_zero[i] != 0 ? sign : 0) << i;
+        }
+        signs[first / BLOCK] = result_signs;
+    }
+    result.data.swap(data);
+    result.signs.swap(signs);
+}
+
+// Operand scanning: row j adds limb j of a times all of b into the product, for all elements of a block
+// at once.
+void big_integer_batch::mul(big_integer_batch& result, const big_integer_batch& a, const big_integer_batch& b) {
+    check_sizes(result, a, b);
+    size_t length = a.width + b.width;
+    std::vector<uint32_t> product(length * BLOCK);
+    std::vector<uint32_t> data(result.data.size());
+    std::vector<uint64_t> signs(result.signs.size());
+    uint64_t carry[BLOCK];
+    uint32_t non_zero[BLOCK];
+    bool overflow = false;
+    for (size_t first = 0; first < a.count; first += BLOCK) {
+        size_t block = std::min(BLOCK, a.count - first);
+        std::fill(product.begin(), product.end(), 0);
+        for (size_t j = 0; j < a.width; ++j) {
+            const uint32_t* x = &a.data[j * a.count + first];
+            std::fill(carry, carry + block, 0);
+            for (size_t k = 0; k < b.width; ++k) {
+                const uint32_t* y = &b.data[k * b.count + first];
+                uint32_t* out = &product[(j + k) * BLOCK];
+                for (size_t i = 0; i < block; ++i) {
+                    uint64_t cur = static_cast<uint64_t>(x[i]) * y[i] + out[i] + carry[i];
+                    out[i] = static_cast<uint32_t>(cur);
+                    carry[i] = cur >> std::numeric_limits<uint32_t>::digits;
+                }
+            }
+            uint32_t* out = &product[(j + b.width) * BLOCK];
+            for (size_t i = 0; i < block; ++i) {
+                out[i] = static_cast<uint32_t>(carry[i]);
+            }
+        }
+        std::fill(non_zero, non_zero + block, 0);
+        for (size_t j = 0; j < length; ++j) {
+            const uint32_t* out = &product[j * BLOCK];
+            for (size_t i = 0; i < block; ++i) {
+                non_zero[i] |= out[i];
+                if (j >= result.width) {
+                    overflow |= out[i] != 0;
+                }
+            }
+        }
+        if (overflow) {
+            throw std::overflow_error("Result doesn't fit into the batch width");
+        }
+        for (size_t j = 0; j < std::min(result.width, length); ++j) {
+            std::copy(&product[j * BLOCK], &product[j * BLOCK] + block, &data[j * result.count + first]);
+        }
+        uint64_t product_signs = a.sign_block(first) ^ b.sign_block(first);
+        uint64_t result_signs = 0;
+        for (size_t i = 0; i < block; ++i) {
+            result_signs |= (non_zero[i] != 0 ? (product_signs >> i) & 1 : 0) << i;
+        }
+        signs[first / BLOCK] = result_signs;
+    }
+    result.data.swap(data);
+    result.signs.swap(signs);
+}
+
+void big_integer_batch::mod(big_integer_batch& result, const big_integer_batch& a, uint32_t m) {
+    if (m == 0) {
+        throw std::invalid_argument("Division by zero");
+    }
+    check_sizes(result, a, a);
+    uint64_t remainder[BLOCK];
+    for (size_t first = 0; first < a.count; first += BLOCK) {
+        size_t block = std::min(BLOCK, a.count - first);
+        std::fill(remainder, remainder + block, 0);
+        for (size_t j = a.width; j > 0; --j) {
+            const uint32_t* x = &a.data[(j - 1) * a.count + first];
+            for (size_t i = 0; i < block; ++i) {
+                remainder[i] = ((remainder[i] << std::numeric_limits<uint32_t>::digits) | x[i]) % m;
+            }
+        }
+        uint64_t a_signs = a.sign_block(first);
+        uint64_t result_signs = 0;
+        for (size_t i = 0; i < block; ++i) {
+            result.data[first + i] = static_cast<uint32_t>(remainder[i]);
+            result_signs |= (remainder[i] != 0 ? (a_signs >> i) & 1 : 0) << i;
+        }
+        for (size_t j = 1; j < result.width; ++j) {
+            std::fill(&result.data[j * result.count + first], &result.data[j * result.count + first] + block, 0);
+        }
+        result.set_sign_block(first, result_signs);
+    }
+}
+
+std::vector<int> big_integer_batch::compare(const big_integer_batch& a, const big_integer_batch& b) {
+    check_sizes(a, a, b);
+    std::vector<int> result(a.count, 0);
+    size_t length = std::max(a.width, b.width);
+    for (size_t j = length; j > 0; --j) {
+        for (size_t i = 0; i < a.count; ++i) {
+            uint32_t x = a.limb(j - 1, i);
+            uint32_t y = b.limb(j - 1, i);
+            int cmp = static_cast<int>(x > y) - static_cast<int>(x < y);
+            result[i] = result[i] != 0 ? result[i] : cmp;
+        }
+    }
+    for (size_t i = 0; i < a.count; ++i) {
+        bool a_negative = ((a.signs[i / BLOCK] >> (i % BLOCK)) & 1) != 0;
+        bool b_negative = ((b.signs[i / BLOCK] >> (i % BLOCK)) & 1) != 0;
+        if (a_negative != b_negative) {
+            result[i] = a_negative ? -1 : 1;
+        } else if (a_negative) {
+            result[i] = -result[i];
+        }
+    }
+    return result;
+}
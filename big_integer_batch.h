@@ -0,0 +1,52 @@
+#pragma once
+
+#include "big_integer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Many signed integers of the same fixed width. Limbs are stored limb-major (limb j of every element,
+// then limb j + 1), so the elementwise kernels walk contiguous memory and vectorize across elements.
+// Signs live in a separate bitmap. A result that does not fit into the width of its batch raises
+// std::overflow_error and leaves the result batch unchanged.
+struct big_integer_batch {
+public:
+    big_integer_batch(size_t count, size_t limbs);
+    big_integer_batch(const std::vector<big_integer>& values, size_t limbs);
+    big_integer_batch(const big_integer_batch& other);
+    ~big_integer_batch();
+
+    big_integer_batch& operator=(const big_integer_batch& other);
+
+    size_t size() const;
+    size_t limbs() const;
+
+    big_integer get(size_t i) const;
+    void set(size_t i, const big_integer& a);
+    std::vector<big_integer> to_vector() const;
+
+    static void add(big_integer_batch& result, const big_integer_batch& a, const big_integer_batch& b);
+    static void sub(big_integer_batch& result, const big_integer_batch& a, const big_integer_batch& b);
+    static void mul(big_integer_batch& result, const big_integer_batch& a, const big_integer_batch& b);
+    // Remainder of every element modulo m, with the sign of the element like operator%.
+    static void mod(big_integer_batch& result, const big_integer_batch& a, uint32_t m);
+    // -1, 0 or 1 for every pair of elements.
+    static std::vector<int> compare(const big_integer_batch& a, const big_integer_batch& b);
+
+private:
+    static constexpr size_t BLOCK = 64;
+
+    size_t count;
+    size_t width;
+    std::vector<uint32_t> data;
+    std::vector<uint64_t> signs;
+
+    uint32_t limb(size_t j, size_t i) const;
+    uint64_t sign_block(size_t first) const;
+    void set_sign_block(size_t first, uint64_t block);
+
+    static void add_or_sub(big_integer_batch& result, const big_integer_batch& a, const big_integer_batch& b,
+                           bool negate_b);
+    static void check_sizes(const big_integer_batch& result, const big_integer_batch& a, const big_integer_batch& b);
+};
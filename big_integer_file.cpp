@@ -0,0 +1,258 @@
+#include "big_integer_file.h"
+#include "mpn.h"
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(std::endian::native == std::endian::little, "Files store limbs in the native byte order");
+
+namespace {
+
+const char FILE_MAGIC[8] = {'B', 'I', 'G', 'I', 'N', 'T', '\0', '\0'};
+const char ARRAY_MAGIC[8] = {'B', 'I', 'G', 'A', 'R', 'R', 'A', 'Y'};
+const size_t INDEX_ALIGNMENT = alignof(big_integer_array_entry);
+// Scratch limbs of an out-of-core multiplication per limb of a block: the product of two blocks, the window
+// of the result it is added to, and about as much again for the Karatsuba temporaries.
+const size_t SCRATCH_LIMBS_PER_BLOCK_LIMB = 8;
+
+template <typename Header>
+Header read_header(std::span<const std::byte> bytes, const char (&magic)[8]) {
+    Header header;
+    if (bytes.size() < sizeof(header)) {
+        throw std::invalid_argument("File is too short for its header");
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (std::memcmp(header.magic, magic, sizeof(header.magic)) != 0) {
+        throw std::invalid_argument("File has the wrong format");
+    }
+    if (header.version != BIG_INTEGER_FILE_VERSION) {
+        throw std::invalid_argument("File has an unsupported version");
+    }
+    return header;
+}
+
+// The limbs at offset, checked to lie within the file.
+std::span<const uint32_t> limbs_at(std::span<const std::byte> bytes, uint64_t offset, uint64_t limbs) {
+    if (offset % alignof(uint32_t) != 0 || offset > bytes.size() ||
+        limbs > (bytes.size() - offset) / sizeof(uint32_t)) {
+        throw std::invalid_argument("File is truncated");
+    }
+    return std::span(reinterpret_cast<const uint32_t*>(bytes.data() + offset), limbs);
+}
+
+void write_limbs(std::ofstream& out, std::span<const uint32_t> limbs) {
+    out.write(reinterpret_cast<const char*>(limbs.data()), static_cast<std::streamsize>(limbs.size_bytes()));
+}
+
+void check_written(const std::ofstream& out, const std::string& path) {
+    if (!out) {
+        throw std::system_error(std::make_error_code(std::errc::io_error), path);
+    }
+}
+
+big_integer_file_header file_header(bool negative, uint64_t limbs) {
+    big_integer_file_header header = {};
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(header.magic));
+    header.version = BIG_INTEGER_FILE_VERSION;
+    header.flags = negative && limbs > 0 ? BIG_INTEGER_FILE_NEGATIVE : 0;
+    header.limbs = limbs;
+    return header;
+}
+
+} // namespace
+
+void write_big_integer_file(const std::string& path, const big_integer_view& a) {
+    big_integer_file_header header = file_header(a.is_negative(), a.limbs().size());
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    write_limbs(out, a.limbs());
+    out.close();
+    check_written(out, path);
+}
+
+// Block pairs (i, j) are multiplied in the order of i + j. Their products all start in block i + j of the
+// result, so once every pair of one sum has been added to the window, its lowest block is final.
+void multiply_big_integer_files(const std::string& a_path, const std::string& b_path,
+                                const std::string& product_path, size_t memory_budget) {
+    size_t block = memory_budget / (SCRATCH_LIMBS_PER_BLOCK_LIMB * sizeof(uint32_t));
+    if (block == 0) {
+        throw std::invalid_argument("Memory budget is too small");
+    }
+    // Truncating the product file while it is mapped as an operand would make reading that operand fault.
+    // equivalent() also sees through links and other spellings of the path, and is false if it doesn't exist.
+    std::error_code error;
+    if (std::filesystem::equivalent(product_path, a_path, error) ||
+        std::filesystem::equivalent(product_path, b_path, error)) {
+        throw std::invalid_argument("Product file must not be one of the operands");
+    }
+    mapped_big_integer a_file(a_path);
+    mapped_big_integer b_file(b_path);
+    std::span<const uint32_t> a = a_file.view().limbs();
+    std::span<const uint32_t> b = b_file.view().limbs();
+    bool negative = a_file.view().is_negative() != b_file.view().is_negative();
+    size_t a_blocks = (a.size() + block - 1) / block;
+    size_t b_blocks = (b.size() + block - 1) / block;
+    uint64_t total = a.empty() || b.empty() ? 0 : a.size() + b.size();
+
+    std::ofstream out(product_path, std::ios::binary | std::ios::trunc);
+    big_integer_file_header header = file_header(negative, total);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    std::vector<uint32_t> product(2 * block);
+    std::vector<uint32_t> window(2 * block + 2);
+    uint64_t written = 0;
+    uint64_t length = 0;
+    for (size_t k = 0; written < total; ++k) {
+        for (size_t i = k >= b_blocks ? k - b_blocks + 1 : 0; i < a_blocks && i <= k; ++i) {
+            std::span<const uint32_t> x = a.subspan(i * block, std::min(block, a.size() - i * block));
+            std::span<const uint32_t> y = b.subspan((k - i) * block, std::min(block, b.size() - (k - i) * block));
+            std::span<uint32_t> p = std::span(product).first(x.size() + y.size());
+            mpn::mul(p, x, y);
+            mpn::add(window, window, p);
+        }
+        size_t count = static_cast<size_t>(std::min<uint64_t>(block, total - written));
+        write_limbs(out, std::span(window).first(count));
+        for (size_t j = count; j > 0; --j) {
+            if (window[j - 1] != 0) {
+                length = written + j;
+                break;
+            }
+        }
+        written += count;
+        std::copy(window.begin() + block, window.end(), window.begin());
+        std::fill(window.end() - block, window.end(), 0);
+    }
+    header = file_header(negative, length);
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    check_written(out, product_path);
+    std::filesystem::resize_file(product_path, sizeof(header) + length * sizeof(uint32_t));
+}
+
+mapped_file::mapped_file(const std::string& path) : address(nullptr), length(0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), path);
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), path);
+    }
+    length = static_cast<size_t>(status.st_size);
+    if (length > 0) {
+        address = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        if (address == MAP_FAILED) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), path);
+        }
+    }
+    ::close(fd);
+}
+
+mapped_file::~mapped_file() {
+    if (address != nullptr) {
+        munmap(address, length);
+    }
+}
+
+std::span<const std::byte> mapped_file::bytes() const {
+    return std::span(static_cast<const std::byte*>(address), length);
+}
+
+mapped_big_integer::mapped_big_integer(const std::string& path) : file(path) {
+    auto header = read_header<big_integer_file_header>(file.bytes(), FILE_MAGIC);
+    value = big_integer_view(limbs_at(file.bytes(), sizeof(header), header.limbs),
+                             (header.flags & BIG_INTEGER_FILE_NEGATIVE) != 0);
+}
+
+big_integer_view mapped_big_integer::view() const {
+    return value;
+}
+
+big_integer_array_writer::big_integer_array_writer(const std::string& path)
+        : path(path), out(path, std::ios::binary | std::ios::trunc), position(sizeof(big_integer_array_header)) {
+    big_integer_array_header header = {};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    check_written(out, path);
+}
+
+// Errors can't be reported from here; call close() to see them.
+big_integer_array_writer::~big_integer_array_writer() {
+    try {
+        close();
+    } catch (const std::system_error&) {
+    }
+}
+
+void big_integer_array_writer::push_back(const big_integer_view& a) {
+    big_integer_array_entry entry = {};
+    entry.offset = position;
+    entry.limbs = a.limbs().size();
+    entry.flags = a.is_negative() ? BIG_INTEGER_FILE_NEGATIVE : 0;
+    index.push_back(entry);
+    write_limbs(out, a.limbs());
+    position += a.limbs().size_bytes();
+}
+
+void big_integer_array_writer::close() {
+    if (!out.is_open()) {
+        return;
+    }
+    const char padding[INDEX_ALIGNMENT] = {};
+    size_t padding_size = (INDEX_ALIGNMENT - position % INDEX_ALIGNMENT) % INDEX_ALIGNMENT;
+    out.write(padding, static_cast<std::streamsize>(padding_size));
+    big_integer_array_header header = {};
+    std::memcpy(header.magic, ARRAY_MAGIC, sizeof(header.magic));
+    header.version = BIG_INTEGER_FILE_VERSION;
+    header.count = index.size();
+    header.index_offset = position + padding_size;
+    out.write(reinterpret_cast<const char*>(index.data()),
+              static_cast<std::streamsize>(index.size() * sizeof(big_integer_array_entry)));
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    check_written(out, path);
+}
+
+mapped_big_integer_array::mapped_big_integer_array(const std::string& path) : file(path) {
+    std::span<const std::byte> bytes = file.bytes();
+    auto header = read_header<big_integer_array_header>(bytes, ARRAY_MAGIC);
+    if (header.index_offset % INDEX_ALIGNMENT != 0 || header.index_offset > bytes.size() ||
+        header.count > (bytes.size() - header.index_offset) / sizeof(big_integer_array_entry)) {
+        throw std::invalid_argument("File is truncated");
+    }
+    index = std::span(reinterpret_cast<const big_integer_array_entry*>(bytes.data() + header.index_offset),
+                      header.count);
+    for (const big_integer_array_entry& entry : index) {
+        limbs_at(bytes, entry.offset, entry.limbs);
+    }
+}
+
+size_t mapped_big_integer_array::size() const {
+    return index.size();
+}
+
+big_integer_view mapped_big_integer_array::operator[](size_t i) const {
+    const big_integer_array_entry& entry = index[i];
+    return big_integer_view(limbs_at(file.bytes(), entry.offset, entry.limbs),
+                            (entry.flags & BIG_INTEGER_FILE_NEGATIVE) != 0);
+}
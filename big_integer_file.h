@@ -0,0 +1,126 @@
+#pragma once
+
+#include "big_integer_view.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Binary files of integers that can be used in place through a read-only memory mapping (POSIX only).
+// Every field and limb is stored little-endian, limbs least significant first and without leading zeros.
+//
+// A single integer is a big_integer_file_header followed by its limbs. An array is a
+// big_integer_array_header, the limbs of every element one after the other, and an index with one
+// big_integer_array_entry per element at index_offset, so elements can be looked up without reading
+// the others.
+
+const uint32_t BIG_INTEGER_FILE_VERSION = 1;
+const uint32_t BIG_INTEGER_FILE_NEGATIVE = 1;
+
+struct big_integer_file_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t limbs;
+};
+
+struct big_integer_array_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t count;
+    uint64_t index_offset;
+};
+
+struct big_integer_array_entry {
+    // Bytes from the start of the file to the first limb.
+    uint64_t offset;
+    uint64_t limbs;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+// The structs are the file layout itself, copied byte for byte and read in place from mappings.
+static_assert(sizeof(big_integer_file_header) == 24, "File header must not contain padding");
+static_assert(sizeof(big_integer_array_header) == 32, "Array header must not contain padding");
+static_assert(sizeof(big_integer_array_entry) == 24, "Array entry must not contain padding");
+static_assert(std::is_trivially_copyable_v<big_integer_file_header>, "File header is copied byte for byte");
+static_assert(std::is_trivially_copyable_v<big_integer_array_header>, "Array header is copied byte for byte");
+static_assert(std::is_trivially_copyable_v<big_integer_array_entry>, "Array entry is copied byte for byte");
+
+void write_big_integer_file(const std::string& path, const big_integer_view& a);
+
+// Multiplies two single-integer files into a third without loading them. The operands are mapped and
+// multiplied in blocks, pair by pair in the order of the product limbs they affect, so the product is
+// written from its lowest limb up and never held in memory. The blocks are sized so that the buffers
+// and scratch limbs stay within about memory_budget bytes; the mapped operands are left to the page cache.
+// Throws std::invalid_argument if product_path names either operand.
+void multiply_big_integer_files(const std::string& a_path, const std::string& b_path,
+                                const std::string& product_path, size_t memory_budget);
+
+// The whole file mapped read-only. Throws std::system_error if it can't be opened or mapped.
+struct mapped_file {
+public:
+    explicit mapped_file(const std::string& path);
+    mapped_file(const mapped_file& other) = delete;
+    ~mapped_file();
+
+    mapped_file& operator=(const mapped_file& other) = delete;
+
+    std::span<const std::byte> bytes() const;
+
+private:
+    void* address;
+    size_t length;
+};
+
+// Throws std::invalid_argument if the file is not a valid single integer.
+struct mapped_big_integer {
+public:
+    explicit mapped_big_integer(const std::string& path);
+
+    // Valid as long as this object lives.
+    big_integer_view view() const;
+
+private:
+    mapped_file file;
+    big_integer_view value;
+};
+
+// Appends elements to an array file. The index and the header are written by close() or the destructor.
+struct big_integer_array_writer {
+public:
+    explicit big_integer_array_writer(const std::string& path);
+    big_integer_array_writer(const big_integer_array_writer& other) = delete;
+    ~big_integer_array_writer();
+
+    big_integer_array_writer& operator=(const big_integer_array_writer& other) = delete;
+
+    void push_back(const big_integer_view& a);
+    // Throws std::system_error if writing failed at any point.
+    void close();
+
+private:
+    std::string path;
+    std::ofstream out;
+    uint64_t position;
+    std::vector<big_integer_array_entry> index;
+};
+
+// Throws std::invalid_argument if the file is not a valid array.
+struct mapped_big_integer_array {
+public:
+    explicit mapped_big_integer_array(const std::string& path);
+
+    size_t size() const;
+    // Valid as long as this object lives.
+    big_integer_view operator[](size_t i) const;
+
+private:
+    mapped_file file;
+    std::span<const big_integer_array_entry> index;
+};
@@ -0,0 +1,48 @@
+#include "big_integer_view.h"
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+big_integer_view::big_integer_view(std::span<const uint32_t> limbs, bool negative) : digits(limbs) {
+    while (!digits.empty() && digits.back() == 0) {
+        digits = digits.first(digits.size() - 1);
+    }
+    this->negative = negative && !digits.empty();
+}
+
+big_integer_view::big_integer_view(const big_integer& a)
+        : big_integer_view(a.limbs(), a.is_negative) {}
+
+big_integer_view::operator big_integer() const {
+    big_integer result;
+    result.assign_limbs(digits);
+    result.is_negative = negative;
+    return result;
+}
+
+std::span<const uint32_t> big_integer_view::limbs() const {
+    return digits;
+}
+
+bool big_integer_view::is_negative() const {
+    return negative;
+}
+
+bool operator==(const big_integer_view& a, const big_integer_view& b) {
+    return (a <=> b) == 0;
+}
+
+std::strong_ordering operator<=>(const big_integer_view& a, const big_integer_view& b) {
+    if (a.is_negative() != b.is_negative()) {
+        return a.is_negative() ? std::strong_ordering::less : std::strong_ordering::greater;
+    }
+    std::span<const uint32_t> x = a.limbs();
+    std::span<const uint32_t> y = b.limbs();
+    std::strong_ordering magnitude = x.size() <=> y.size();
+    for (size_t i = x.size(); magnitude == 0 && i > 0; --i) {
+        magnitude = x[i - 1] <=> y[i - 1];
+    }
+    return a.is_negative() ? 0 <=> magnitude : magnitude;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "big_integer.h"
+
+#include <compare>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Read-only signed integer over limbs owned by someone else, e.g. a mapped file or a big_integer that
+// outlives the view. The operations whose cost grows faster than the size of their operands read the
+// limbs in place; anything else is cheapest on an explicit big_integer copy, which costs as much as one
+// linear pass.
+struct big_integer_view {
+public:
+    big_integer_view() = default;
+    // Leading zero limbs are ignored.
+    big_integer_view(std::span<const uint32_t> limbs, bool negative);
+    big_integer_view(const big_integer& a);
+
+    explicit operator big_integer() const;
+
+    // Without leading zeros, empty for zero.
+    std::span<const uint32_t> limbs() const;
+    bool is_negative() const;
+
+private:
+    std::span<const uint32_t> digits;
+    bool negative = false;
+};
+
+bool operator==(const big_integer_view& a, const big_integer_view& b);
+std::strong_ordering operator<=>(const big_integer_view& a, const big_integer_view& b);
+
+big_integer operator*(const big_integer_view& a, const big_integer_view& b);
+big_integer operator/(const big_integer_view& a, const big_integer_view& b);
+big_integer operator%(const big_integer_view& a, const big_integer_view& b);
+
+std::string to_string(const big_integer_view& a);
+void write_decimal(const big_integer_view& a, const std::function<void(std::string_view)>& sink);
+std::ostream& operator<<(std::ostream& out, const big_integer_view& a);
@@ -0,0 +1,145 @@
+#include "big_integer.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+
+// Throughput of the big_integer operators for operands of 1 to 10^6 limbs. Division, remainder and
+// decimal output are quadratic in this tree and stop at 10^5 limbs. For JSON, run with
+// --benchmark_format=json, or --benchmark_out=<file> --benchmark_out_format=json.
+//
+// Compound operators work on a copy of the left operand made in every iteration, so `copy` is the
+// baseline to subtract for the linear ones.
+
+namespace {
+
+const int64_t MAX_LIMBS = 1'000'000;
+const int64_t MAX_QUADRATIC_LIMBS = 100'000;
+const int SHIFT = 77;
+
+std::mt19937 generator(20240229);
+
+// limbs random limbs, assembled from halves so that operands of 10^6 limbs are built in O(n log n).
+big_integer random_limbs(size_t limbs) {
+    if (limbs == 1) {
+        return generator();
+    }
+    size_t low_limbs = limbs / 2;
+    big_integer result = random_limbs(limbs - low_limbs);
+    result <<= static_cast<int>(low_limbs * 32);
+    return result += random_limbs(low_limbs);
+}
+
+// A number of exactly limbs limbs.
+big_integer random_number(size_t limbs) {
+    big_integer top = big_integer(1) << static_cast<int>(limbs * 32 - 1);
+    return random_limbs(limbs) | top;
+}
+
+void set_bytes_processed(benchmark::State& state, int64_t limbs) {
+    state.SetBytesProcessed(state.iterations() * limbs * static_cast<int64_t>(sizeof(uint32_t)));
+}
+
+void copy(benchmark::State& state) {
+    big_integer a = random_number(state.range(0));
+    for (auto _ : state) {
+        big_integer x = a;
+        benchmark::DoNotOptimize(x);
+    }
+    set_bytes_processed(state, state.range(0));
+}
+
+// x op= b for x of lhs_scale * n limbs and b of n limbs.
+template <typename Operation>
+void binary(benchmark::State& state, Operation operation, int64_t lhs_scale) {
+    int64_t n = state.range(0);
+    big_integer a = random_number(lhs_scale * n);
+    big_integer b = random_number(n);
+    for (auto _ : state) {
+        big_integer x = a;
+        operation(x, b);
+        benchmark::DoNotOptimize(x);
+    }
+    set_bytes_processed(state, (lhs_scale + 1) * n);
+}
+
+template <typename Operation>
+void unary(benchmark::State& state, Operation operation) {
+    big_integer a = random_number(state.range(0));
+    for (auto _ : state) {
+        big_integer x = a;
+        operation(x);
+        benchmark::DoNotOptimize(x);
+    }
+    set_bytes_processed(state, state.range(0));
+}
+
+void compare(benchmark::State& state) {
+    big_integer a = random_number(state.range(0));
+    big_integer b = a;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a < b);
+    }
+    set_bytes_processed(state, 2 * state.range(0));
+}
+
+void decimal_output(benchmark::State& state) {
+    big_integer a = random_number(state.range(0));
+    for (auto _ : state) {
+        std::string digits = to_string(a);
+        benchmark::DoNotOptimize(digits);
+    }
+    set_bytes_processed(state, state.range(0));
+}
+
+// The digits of a number of about n limbs are generated directly, since decimal output is quadratic.
+void decimal_input(benchmark::State& state) {
+    std::uniform_int_distribution<int> digit('0', '9');
+    std::string digits(static_cast<size_t>(state.range(0) * 32 * 0.30103) + 1, '1');
+    for (size_t i = 1; i < digits.size(); ++i) {
+        digits[i] = static_cast<char>(digit(generator));
+    }
+    for (auto _ : state) {
+        big_integer a(digits);
+        benchmark::DoNotOptimize(a);
+    }
+    set_bytes_processed(state, state.range(0));
+}
+
+void linear_sizes(benchmark::internal::Benchmark* benchmark) {
+    benchmark->RangeMultiplier(10)->Range(1, MAX_LIMBS);
+}
+
+void quadratic_sizes(benchmark::internal::Benchmark* benchmark) {
+    benchmark->RangeMultiplier(10)->Range(1, MAX_QUADRATIC_LIMBS)->Unit(benchmark::kMicrosecond);
+}
+
+} // namespace
+
+BENCHMARK(copy)->Apply(linear_sizes);
+BENCHMARK_CAPTURE(binary, add, [](big_integer& x, const big_integer& b) { x += b; }, 1)->Apply(linear_sizes);
+BENCHMARK_CAPTURE(binary, subtract, [](big_integer& x, const big_integer& b) { x -= b; }, 1)->Apply(linear_sizes);
+BENCHMARK_CAPTURE(binary, multiply, [](big_integer& x, const big_integer& b) { x *= b; }, 1)
+    ->Apply(linear_sizes)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(unary, square, [](big_integer& x) { x *= x; })->Apply(linear_sizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(binary, divide, [](big_integer& x, const big_integer& b) { x /= b; }, 2)->Apply(quadratic_sizes);
+BENCHMARK_CAPTURE(binary, modulo, [](big_integer& x, const big_integer& b) { x %= b; }, 2)->Apply(quadratic_sizes);
+BENCHMARK_CAPTURE(unary, multiply_native, [](big_integer& x) { x *= 0x9e3779b97f4a7c15u; })->Apply(linear_sizes);
+BENCHMARK_CAPTURE(unary, divide_native, [](big_integer& x) { x /= 0x9e3779b97f4a7c15u; })->Apply(linear_sizes);
+BENCHMARK_CAPTURE(binary, bitwise_and, [](big_integer& x, const big_integer& b) { x &= b; }, 1)->Apply(linear_sizes);
+BENCHMARK_CAPTURE(binary, bitwise_or, [](big_integer& x, const big_integer& b) { x |= b; }, 1)->Apply(linear_sizes);
+BENCHMARK_CAPTURE(binary, bitwise_xor, [](big_integer& x, const big_integer& b) { x ^= b; }, 1)->Apply(linear_sizes);
+BENCHMARK_CAPTURE(unary, bitwise_not, [](big_integer& x) { x = ~x; })->Apply(linear_sizes);
+BENCHMARK_CAPTURE(unary, negate, [](big_integer& x) { x = -x; })->Apply(linear_sizes);
+BENCHMARK_CAPTURE(unary, shift_left, [](big_integer& x) { x <<= SHIFT; })->Apply(linear_sizes);
+BENCHMARK_CAPTURE(unary, shift_right, [](big_integer& x) { x >>= SHIFT; })->Apply(linear_sizes);
+BENCHMARK_CAPTURE(unary, increment, [](big_integer& x) { ++x; })->Apply(linear_sizes);
+BENCHMARK(compare)->Apply(linear_sizes);
+BENCHMARK(decimal_output)->Apply(quadratic_sizes);
+BENCHMARK(decimal_input)->Apply(linear_sizes)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
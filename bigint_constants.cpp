@@ -0,0 +1,151 @@
+#include "big_integer.h"
+#include "number_theory.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+
+// End-to-end benchmark: computes the given number of decimal digits of pi with the Chudnovsky series and
+// of e with the series of 1 / k!, both summed by binary splitting through the public big_integer API.
+// Every phase is timed separately: binary splitting is almost entirely multiplication, followed by the
+// square root (pi only), the final division and the decimal output.
+
+namespace {
+
+const size_t DEFAULT_DIGITS = 100'000;
+// Guard digits computed beyond the requested ones and cut off, so that truncation errors stay invisible.
+const size_t GUARD_DIGITS = 16;
+const double CHUDNOVSKY_DIGITS_PER_TERM = 14.181647462725477;
+// 640320^3 / 24
+const uint64_t CHUDNOVSKY_C3_OVER_24 = 10939058860032000;
+
+struct split {
+    big_integer p;
+    big_integer q;
+    big_integer t;
+};
+
+// Chudnovsky terms [a, b): p / q is the ratio of the term b to the term a, t / q is their sum scaled to
+// the term a.
+split chudnovsky(uint64_t a, uint64_t b) {
+    if (b - a == 1) {
+        split result;
+        if (a == 0) {
+            result.p = 1;
+            result.q = 1;
+        } else {
+            result.p = big_integer(6 * a - 5) * (2 * a - 1) * (6 * a - 1);
+            result.q = big_integer(a) * a * a * CHUDNOVSKY_C3_OVER_24;
+        }
+        result.t = result.p * (13591409 + 545140134 * a);
+        if (a % 2 == 1) {
+            result.t = -result.t;
+        }
+        return result;
+    }
+    uint64_t m = a + (b - a) / 2;
+    split left = chudnovsky(a, m);
+    split right = chudnovsky(m, b);
+    return {left.p * right.p, left.q * right.q, left.t * right.q + left.p * right.t};
+}
+
+// p / q = sum of a! / k! over k in (a, b].
+std::pair<big_integer, big_integer> exponential(uint64_t a, uint64_t b) {
+    if (b - a == 1) {
+        return {1, b};
+    }
+    uint64_t m = a + (b - a) / 2;
+    auto [left_p, left_q] = exponential(a, m);
+    auto [right_p, right_q] = exponential(m, b);
+    return {left_p * right_q + right_p, left_q * right_q};
+}
+
+big_integer power_of_ten(size_t exponent) {
+    big_integer result = 1;
+    big_integer base = 10;
+    for (; exponent > 0; exponent /= 2) {
+        if (exponent % 2 == 1) {
+            result *= base;
+        }
+        base *= base;
+    }
+    return result;
+}
+
+struct phase_timer {
+public:
+    template <typename Function>
+    auto operator()(const char* phase, Function function) {
+        auto start = std::chrono::steady_clock::now();
+        auto result = function();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        total += seconds;
+        std::cout << "  " << phase << ": " << seconds << " s\n";
+        return result;
+    }
+
+    void report() const {
+        std::cout << "  total: " << total << " s\n";
+    }
+
+private:
+    double total = 0;
+};
+
+// The first and last digits after the decimal point.
+void print_digits(const std::string& digits, size_t count) {
+    const size_t shown = 20;
+    std::cout << "  " << digits[0] << '.' << digits.substr(1, shown);
+    if (count > 2 * shown) {
+        std::cout << "..." << digits.substr(count + 1 - shown, shown);
+    }
+    std::cout << '\n';
+}
+
+void compute_pi(size_t digits) {
+    std::cout << "pi, " << digits << " digits\n";
+    phase_timer timer;
+    uint64_t terms = static_cast<uint64_t>((digits + GUARD_DIGITS) / CHUDNOVSKY_DIGITS_PER_TERM) + 2;
+    split series = timer("binary splitting", [&] { return chudnovsky(0, terms); });
+    big_integer scale = power_of_ten(digits + GUARD_DIGITS);
+    big_integer root = timer("isqrt", [&] { return isqrt(scale * scale * 10005); });
+    big_integer pi = timer("division", [&] {
+        return series.q * root * 426880 / series.t / power_of_ten(GUARD_DIGITS);
+    });
+    std::string text = timer("decimal output", [&] { return to_string(pi); });
+    timer.report();
+    print_digits(text, digits);
+}
+
+void compute_e(size_t digits) {
+    std::cout << "e, " << digits << " digits\n";
+    phase_timer timer;
+    double target = (digits + GUARD_DIGITS) * std::log(10.0);
+    double log_factorial = 0;
+    uint64_t terms = 1;
+    while (log_factorial <= target) {
+        log_factorial += std::log(static_cast<double>(++terms));
+    }
+    auto [p, q] = timer("binary splitting", [&] { return exponential(0, terms); });
+    big_integer e = timer("division", [&] { return (p + q) * power_of_ten(digits) / q; });
+    std::string text = timer("decimal output", [&] { return to_string(e); });
+    timer.report();
+    print_digits(text, digits);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t digits = DEFAULT_DIGITS;
+    if (argc > 2 || (argc == 2 && (digits = std::strtoull(argv[1], nullptr, 10)) == 0)) {
+        std::cerr << "Usage: " << argv[0] << " [digits]\n";
+        return 1;
+    }
+    compute_pi(digits);
+    compute_e(digits);
+    return 0;
+}
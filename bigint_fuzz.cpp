@@ -0,0 +1,249 @@
+#include "big_integer.h"
+#include "number_theory.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Differential fuzz target. Every input is decoded into a few numbers biased towards carry edges (zero,
+// all-ones and top-bit limbs, powers of two and their neighbours), and each operator is checked against
+// the same operation on the other algorithm tiers and against identities that tie the operators together.
+// Any mismatch aborts with the failing check.
+//
+// Built with -DBIGINT_LIBFUZZER=ON under Clang this is a libFuzzer target. Otherwise it has its own main:
+// given files it runs each as one input, given nothing it runs random inputs forever, and given
+// --runs=N it stops after N of them.
+
+namespace {
+
+const size_t MAX_LIMBS = 160;
+const algorithm_thresholds BASECASE_THRESHOLDS = {
+    .karatsuba_multiplication = std::numeric_limits<size_t>::max(),
+    .karatsuba_square = std::numeric_limits<size_t>::max(),
+    .add_product_rows = std::numeric_limits<size_t>::max(),
+    // Multiplied by the digits per limb internally, so it must not overflow.
+    .decimal_conversion = std::numeric_limits<size_t>::max() / 16,
+    .half_gcd = std::numeric_limits<size_t>::max(),
+};
+const algorithm_thresholds FAST_THRESHOLDS = {
+    .karatsuba_multiplication = 4,
+    .karatsuba_square = 4,
+    .add_product_rows = 1,
+    .decimal_conversion = 1,
+    .half_gcd = 2,
+};
+// Splits the Karatsuba subproducts and decimal conversions of all but small operands into tasks.
+const parallel_options PARALLEL_OPTIONS = {
+    .threads = 4,
+    .multiplication_cutoff = 16,
+    .conversion_cutoff = 8,
+};
+
+struct input_reader {
+public:
+    input_reader(const uint8_t* data, size_t size) : data(data), size(size), position(0) {}
+
+    uint8_t byte() {
+        return position < size ? data[position++] : 0;
+    }
+
+    uint32_t limb() {
+        switch (byte() % 8) {
+        case 0:
+            return 0;
+        case 1:
+            return UINT32_MAX;
+        case 2:
+            return uint32_t(1) << 31;
+        case 3:
+            return 1;
+        default:
+            uint32_t result = 0;
+            for (int i = 0; i < 4; ++i) {
+                result = (result << 8) | byte();
+            }
+            return result;
+        }
+    }
+
+    big_integer number() {
+        uint8_t shape = byte();
+        size_t limbs = byte() % 4 == 0 ? byte() % MAX_LIMBS : byte() % 4;
+        big_integer result;
+        if (shape % 4 == 0) {
+            // A power of two, possibly off by a small amount.
+            result = big_integer(1) << static_cast<int>(byte() % 32 + 32 * limbs);
+            result += static_cast<int>(byte() % 5) - 2;
+        } else {
+            for (size_t i = 0; i < limbs; ++i) {
+                result <<= 32;
+                result += limb();
+            }
+        }
+        return shape % 3 == 0 ? -result : result;
+    }
+
+    int64_t native() {
+        int64_t result = 0;
+        for (int i = 0; i < 8; ++i) {
+            result = static_cast<int64_t>((static_cast<uint64_t>(result) << 8) | byte());
+        }
+        return result;
+    }
+
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t position;
+};
+
+void check(bool condition, const char* what, const big_integer& a, const big_integer& b) {
+    if (!condition) {
+        std::cerr << "Check failed: " << what << "\na = " << a << "\nb = " << b << '\n';
+        std::abort();
+    }
+}
+
+template <typename Operation>
+void check_tiers(const char* what, const big_integer& a, const big_integer& b, Operation operation) {
+    set_algorithm_thresholds(BASECASE_THRESHOLDS);
+    auto basecase = operation();
+    set_algorithm_thresholds(FAST_THRESHOLDS);
+    auto fast = operation();
+    check(basecase == fast, what, a, b);
+}
+
+// floor(a / 2^shift), the value of a >> shift.
+big_integer floor_shift(const big_integer& a, int shift) {
+    big_integer divisor = big_integer(1) << shift;
+    big_integer quotient = a / divisor;
+    if (a < 0 && a % divisor != 0) {
+        --quotient;
+    }
+    return quotient;
+}
+
+void check_pair(const big_integer& a, const big_integer& b, const big_integer& c, int shift, int64_t v) {
+    algorithm_thresholds defaults = get_algorithm_thresholds();
+
+    // The fast tier runs once sequentially and once split into tasks, the basecase never splits.
+    parallel_options options = get_parallel_options();
+    for (const parallel_options& tier : {options, PARALLEL_OPTIONS}) {
+        set_parallel_options(tier);
+        check_tiers("a * b", a, b, [&] { return a * b; });
+        check_tiers("a * a", a, b, [&] {
+            big_integer square = a;
+            square *= square;
+            return square;
+        });
+        check_tiers("addmul", a, b, [&] {
+            big_integer acc = c;
+            addmul(acc, a, b);
+            return acc;
+        });
+        check_tiers("submul", a, b, [&] {
+            big_integer acc = c;
+            submul(acc, a, b);
+            return acc;
+        });
+        check_tiers("to_string", a, b, [&] { return to_string(a * b); });
+        check_tiers("string constructor", a, b, [&] { return big_integer(to_string(a * b)); });
+        check_tiers("gcd", a, b, [&] { return gcd(a * c, b * c); });
+        // Cofactors are only unique up to the sign of a tie, so each tier checks its own.
+        check_tiers("xgcd", a, b, [&] {
+            big_integer x = a * c;
+            big_integer y = b * c;
+            auto [g, u, v] = xgcd(x, y);
+            big_integer bound = g == 0 ? big_integer(1) : y / g;
+            bool valid = x * u + y * v == g && (y == 0 || u * u <= bound * bound || u * u == 1);
+            return std::make_pair(g, valid);
+        });
+    }
+    set_parallel_options(options);
+    set_algorithm_thresholds(defaults);
+
+    check(a + b - b == a, "a + b - b == a", a, b);
+    check(a - b == -(b - a), "a - b == -(b - a)", a, b);
+    check(a * b == b * a, "a * b == b * a", a, b);
+    check((a + b) * (a - b) == a * a - b * b, "(a + b) * (a - b) == a^2 - b^2", a, b);
+    check(big_integer(to_string(a)) == a, "string round trip", a, b);
+    if (b != 0) {
+        big_integer q = a / b;
+        big_integer r = a % b;
+        check(q * b + r == a, "(a / b) * b + a % b == a", a, b);
+        check((r < 0 ? -r : r) < (b < 0 ? -b : b), "|a % b| < |b|", a, b);
+        check(r == 0 || (r < 0) == (a < 0), "a % b has the sign of a", a, b);
+        check(mulmod(a, c, b) == a * c % b, "mulmod", a, b);
+    }
+
+    check((a & b) + (a | b) == a + b, "(a & b) + (a | b) == a + b", a, b);
+    check((a ^ b) == (a | b) - (a & b), "a ^ b == (a | b) - (a & b)", a, b);
+    check(~a == -a - 1, "~a == -a - 1", a, b);
+    check((a << shift) == a * (big_integer(1) << shift), "a << k == a * 2^k", a, b);
+    check((a >> shift) == floor_shift(a, shift), "a >> k == floor(a / 2^k)", a, b);
+
+    big_integer w = v;
+    check(a + v == a + w, "a + native", a, w);
+    check(v - a == w - a, "native - a", a, w);
+    check(a * v == a * w, "a * native", a, w);
+    check((a & v) == (a & w), "a & native", a, w);
+    check((a | v) == (a | w), "a | native", a, w);
+    check((a ^ v) == (a ^ w), "a ^ native", a, w);
+    check((a < v) == (a < w) && (a == v) == (a == w), "a <=> native", a, w);
+    if (v != 0) {
+        check(a / v == a / w, "a / native", a, w);
+        check(a % v == a % w, "a % native", a, w);
+    }
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    input_reader reader(data, size);
+    big_integer a = reader.number();
+    big_integer b = reader.number();
+    big_integer c = reader.number();
+    int shift = reader.byte() % 160;
+    int64_t v = reader.native();
+    check_pair(a, b, c, shift, v);
+    check_pair(b, a, c, shift, v);
+    return 0;
+}
+
+#ifndef BIGINT_LIBFUZZER
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]).rfind("--runs=", 0) != 0) {
+        for (int i = 1; i < argc; ++i) {
+            std::ifstream file(argv[i], std::ios::binary);
+            std::vector<uint8_t> input((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            LLVMFuzzerTestOneInput(input.data(), input.size());
+        }
+        return 0;
+    }
+    uint64_t runs = argc > 1 ? std::strtoull(argv[1] + 7, nullptr, 10) : 0;
+    std::mt19937_64 generator(std::random_device{}());
+    std::vector<uint8_t> input;
+    for (uint64_t run = 1; runs == 0 || run <= runs; ++run) {
+        input.resize(generator() % 2048);
+        for (uint8_t& byte : input) {
+            byte = static_cast<uint8_t>(generator());
+        }
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+        if (run % 1000 == 0) {
+            std::cerr << run << " inputs\n";
+        }
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,144 @@
+#include "big_integer.h"
+#include "number_theory.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+
+// Measures the crossovers of algorithm_thresholds on this machine and writes them as tuned_thresholds.h to
+// the path given as the only argument, or to the standard output. Like GMP's tuneup, every size n is timed
+// with the threshold at n + 1, which keeps the operation on the basecase, and at n, which applies the faster
+// algorithm once at the top level and the basecase below it.
+
+namespace {
+
+const size_t MAX_SIZE = 1024;
+const size_t CONFIRMATIONS = 3;
+const int BATCHES = 3;
+const std::chrono::milliseconds MIN_BATCH_TIME(10);
+
+std::mt19937 generator(20240229);
+
+big_integer random_number(size_t limbs) {
+    big_integer result = generator() | (uint32_t(1) << 31);
+    for (size_t i = 1; i < limbs; ++i) {
+        result <<= 32;
+        result += generator();
+    }
+    return result;
+}
+
+// Seconds per call: the fastest of several batches, each repeating the operation long enough for the clock.
+double measure(const std::function<void()>& operation) {
+    using clock = std::chrono::steady_clock;
+    operation();
+    double best = 0;
+    for (int batch = 0; batch < BATCHES; ++batch) {
+        size_t calls = 0;
+        clock::time_point start = clock::now();
+        clock::duration elapsed;
+        do {
+            operation();
+            ++calls;
+            elapsed = clock::now() - start;
+        } while (elapsed < MIN_BATCH_TIME);
+        double per_call = std::chrono::duration<double>(elapsed).count() / calls;
+        if (batch == 0 || per_call < best) {
+            best = per_call;
+        }
+    }
+    return best;
+}
+
+// The first size from which the faster algorithm wins on CONFIRMATIONS consecutive sizes. It is installed
+// before returning, so thresholds tuned later run on top of it.
+size_t tune(const char* name, size_t algorithm_thresholds::*field, size_t min_size,
+            const std::function<std::function<void()>(size_t)>& make_operation) {
+    algorithm_thresholds thresholds = get_algorithm_thresholds();
+    size_t crossover = MAX_SIZE;
+    size_t wins = 0;
+    for (size_t n = min_size; n < MAX_SIZE && wins < CONFIRMATIONS; n += std::max<size_t>(1, n / 16)) {
+        std::function<void()> operation = make_operation(n);
+        thresholds.*field = n + 1;
+        set_algorithm_thresholds(thresholds);
+        double basecase = measure(operation);
+        thresholds.*field = n;
+        set_algorithm_thresholds(thresholds);
+        double faster = measure(operation);
+        std::cerr << name << ' ' << n << ": " << basecase * 1e6 << " us / " << faster * 1e6 << " us\n";
+        if (faster < basecase) {
+            if (wins++ == 0) {
+                crossover = n;
+            }
+        } else {
+            wins = 0;
+            crossover = MAX_SIZE;
+        }
+    }
+    thresholds.*field = crossover;
+    set_algorithm_thresholds(thresholds);
+    std::cerr << name << " = " << crossover << '\n';
+    return crossover;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc > 2) {
+        std::cerr << "Usage: " << argv[0] << " [output header]\n";
+        return 1;
+    }
+    big_integer result;
+    algorithm_thresholds tuned;
+    tuned.karatsuba_multiplication =
+        tune("karatsuba_multiplication", &algorithm_thresholds::karatsuba_multiplication, 4, [&](size_t n) {
+            return [&result, a = random_number(n), b = random_number(n)] { result = a * b; };
+        });
+    tuned.karatsuba_square = tune("karatsuba_square", &algorithm_thresholds::karatsuba_square, 4, [&](size_t n) {
+        return [&result, a = random_number(n)] {
+            result = a;
+            result *= result;
+        };
+    });
+    tuned.add_product_rows = tune("add_product_rows", &algorithm_thresholds::add_product_rows, 1, [&](size_t n) {
+        return [&result, a = random_number(n), b = random_number(n), c = random_number(2 * n)] {
+            result = c;
+            addmul(result, a, b);
+        };
+    });
+    tuned.decimal_conversion = tune("decimal_conversion", &algorithm_thresholds::decimal_conversion, 1,
+                                    [](size_t n) { return [a = random_number(n)] { to_string(a); }; });
+    tuned.half_gcd = tune("half_gcd", &algorithm_thresholds::half_gcd, 64, [&](size_t n) {
+        return [&result, a = random_number(n), b = random_number(n)] { result = gcd(a, b); };
+    });
+
+    std::ofstream file;
+    if (argc == 2) {
+        file.open(argv[1]);
+        if (!file) {
+            std::cerr << "Cannot open " << argv[1] << '\n';
+            return 1;
+        }
+    }
+    std::ostream& out = argc == 2 ? file : std::cout;
+    out << "#pragma once\n"
+           "\n"
+           "#include \"big_integer.h\"\n"
+           "\n"
+           "// Generated by bigint_tune on the build machine. Rebuild the library to apply, or delete this file\n"
+           "// to go back to the portable defaults in the source tree.\n"
+           "inline constexpr algorithm_thresholds TUNED_THRESHOLDS = {\n"
+        << "    .karatsuba_multiplication = " << tuned.karatsuba_multiplication << ",\n"
+        << "    .karatsuba_square = " << tuned.karatsuba_square << ",\n"
+        << "    .add_product_rows = " << tuned.add_product_rows << ",\n"
+        << "    .decimal_conversion = " << tuned.decimal_conversion << ",\n"
+        << "    .half_gcd = " << tuned.half_gcd << ",\n"
+        << "};\n";
+    return out ? 0 : 1;
+}
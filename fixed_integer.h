@@ -0,0 +1,372 @@
+#pragma once
+
+#include "big_integer.h"
+#include "mpn.h"
+
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+// Integer of exactly Bits bits in two's complement, held in an array of limbs so it never allocates.
+// Arithmetic wraps around modulo 2^Bits like the built-in types, and division truncates towards zero.
+// Up to UNROLLED_LIMBS limbs, the loops over the limbs are unrolled into straight-line code by fold
+// expressions over the limb indices, except in division, whose length depends on the operands. Wider
+// numbers keep plain loops, which are about as fast there and much cheaper to compile. Everything but the
+// conversions to and from big_integer is constexpr; division at run time goes through the mpn kernels.
+template <size_t Bits, bool Signed = true>
+struct fixed_integer {
+    static_assert(Bits > 0 && Bits % std::numeric_limits<uint32_t>::digits == 0,
+                  "Width must be a positive multiple of the limb width");
+
+public:
+    constexpr fixed_integer() = default;
+
+    template <native_integer T>
+    constexpr fixed_integer(T a) {
+        uint64_t bits = static_cast<uint64_t>(a);
+        uint32_t fill = std::cmp_less(a, 0) ? UINT32_MAX : 0;
+        unroll<LIMBS>([&](auto i) {
+            value[i] = i < 2 ? static_cast<uint32_t>(bits >> (i * LIMB_BITS)) : fill;
+        });
+    }
+
+    template <size_t OtherBits, bool OtherSigned>
+    constexpr explicit fixed_integer(const fixed_integer<OtherBits, OtherSigned>& other) {
+        uint32_t fill = other.is_negative() ? UINT32_MAX : 0;
+        unroll<LIMBS>([&](auto i) {
+            value[i] = i < other.value.size() ? other.value[i] : fill;
+        });
+    }
+
+    // Keeps the low Bits bits of the two's complement of a.
+    explicit fixed_integer(const big_integer& a) {
+        std::span<const uint32_t> digits = a.limbs();
+        unroll<LIMBS>([&](auto i) {
+            value[i] = i < digits.size() ? digits[i] : 0;
+        });
+        if (a.is_negative) {
+            negate();
+        }
+    }
+
+    explicit operator big_integer() const {
+        fixed_integer magnitude = *this;
+        if (is_negative()) {
+            magnitude.negate();
+        }
+        big_integer result;
+        result.assign_limbs(magnitude.value);
+        result.is_negative = is_negative() && result != 0;
+        return result;
+    }
+
+    constexpr fixed_integer& operator+=(const fixed_integer& rhs) {
+        uint64_t carry = 0;
+        unroll<LIMBS>([&](auto i) {
+            uint64_t cur = static_cast<uint64_t>(value[i]) + rhs.value[i] + carry;
+            value[i] = static_cast<uint32_t>(cur);
+            carry = cur >> LIMB_BITS;
+        });
+        return *this;
+    }
+
+    constexpr fixed_integer& operator-=(const fixed_integer& rhs) {
+        uint64_t borrow = 0;
+        unroll<LIMBS>([&](auto i) {
+            uint64_t cur = static_cast<uint64_t>(value[i]) - rhs.value[i] - borrow;
+            value[i] = static_cast<uint32_t>(cur);
+            borrow = (cur >> LIMB_BITS) & 1;
+        });
+        return *this;
+    }
+
+    // Only the products that land in the low Bits bits are computed.
+    constexpr fixed_integer& operator*=(const fixed_integer& rhs) {
+        std::array<uint32_t, LIMBS> result{};
+        unroll<LIMBS>([&](auto i) {
+            uint64_t carry = 0;
+            auto step = [&](auto j) {
+                uint64_t cur = static_cast<uint64_t>(value[i]) * rhs.value[j] + result[i + j] + carry;
+                result[i + j] = static_cast<uint32_t>(cur);
+                carry = cur >> LIMB_BITS;
+            };
+            if constexpr (LIMBS <= UNROLLED_LIMBS) {
+                unroll<LIMBS - i>(step);
+            } else {
+                for (size_t j = 0; i + j < LIMBS; ++j) {
+                    step(j);
+                }
+            }
+        });
+        value = result;
+        return *this;
+    }
+
+    constexpr fixed_integer& operator/=(const fixed_integer& rhs) {
+        fixed_integer remainder;
+        div_mod(*this, rhs, *this, remainder);
+        return *this;
+    }
+
+    constexpr fixed_integer& operator%=(const fixed_integer& rhs) {
+        fixed_integer quotient;
+        div_mod(*this, rhs, quotient, *this);
+        return *this;
+    }
+
+    constexpr fixed_integer& operator&=(const fixed_integer& rhs) {
+        unroll<LIMBS>([&](auto i) {
+            value[i] &= rhs.value[i];
+        });
+        return *this;
+    }
+
+    constexpr fixed_integer& operator|=(const fixed_integer& rhs) {
+        unroll<LIMBS>([&](auto i) {
+            value[i] |= rhs.value[i];
+        });
+        return *this;
+    }
+
+    constexpr fixed_integer& operator^=(const fixed_integer& rhs) {
+        unroll<LIMBS>([&](auto i) {
+            value[i] ^= rhs.value[i];
+        });
+        return *this;
+    }
+
+    constexpr fixed_integer& operator<<=(int rhs) {
+        size_t digits_shift = static_cast<size_t>(rhs) / LIMB_BITS;
+        int shift = rhs % LIMB_BITS;
+        unroll<LIMBS>([&](auto k) {
+            size_t i = LIMBS - k;
+            uint32_t high = i - 1 >= digits_shift ? value[i - 1 - digits_shift] : 0;
+            uint32_t low = i - 1 >= digits_shift + 1 ? value[i - 2 - digits_shift] : 0;
+            value[i - 1] = shift == 0 ? high : (high << shift) | (low >> (LIMB_BITS - shift));
+        });
+        return *this;
+    }
+
+    // Arithmetic for signed widths, so negative numbers round towards negative infinity like big_integer.
+    constexpr fixed_integer& operator>>=(int rhs) {
+        size_t digits_shift = static_cast<size_t>(rhs) / LIMB_BITS;
+        int shift = rhs % LIMB_BITS;
+        uint32_t fill = is_negative() ? UINT32_MAX : 0;
+        unroll<LIMBS>([&](auto i) {
+            uint32_t low = i + digits_shift < LIMBS ? value[i + digits_shift] : fill;
+            uint32_t high = i + digits_shift + 1 < LIMBS ? value[i + digits_shift + 1] : fill;
+            value[i] = shift == 0 ? low : (low >> shift) | (high << (LIMB_BITS - shift));
+        });
+        return *this;
+    }
+
+    constexpr fixed_integer operator+() const {
+        return *this;
+    }
+
+    constexpr fixed_integer operator-() const {
+        fixed_integer result = *this;
+        result.negate();
+        return result;
+    }
+
+    constexpr fixed_integer operator~() const {
+        fixed_integer result = *this;
+        unroll<LIMBS>([&](auto i) {
+            result.value[i] = ~result.value[i];
+        });
+        return result;
+    }
+
+    constexpr fixed_integer& operator++() {
+        return *this += 1;
+    }
+
+    constexpr fixed_integer operator++(int) {
+        fixed_integer result = *this;
+        ++*this;
+        return result;
+    }
+
+    constexpr fixed_integer& operator--() {
+        return *this -= 1;
+    }
+
+    constexpr fixed_integer operator--(int) {
+        fixed_integer result = *this;
+        --*this;
+        return result;
+    }
+
+    friend constexpr fixed_integer operator+(fixed_integer a, const fixed_integer& b) {
+        return a += b;
+    }
+
+    friend constexpr fixed_integer operator-(fixed_integer a, const fixed_integer& b) {
+        return a -= b;
+    }
+
+    friend constexpr fixed_integer operator*(fixed_integer a, const fixed_integer& b) {
+        return a *= b;
+    }
+
+    friend constexpr fixed_integer operator/(fixed_integer a, const fixed_integer& b) {
+        return a /= b;
+    }
+
+    friend constexpr fixed_integer operator%(fixed_integer a, const fixed_integer& b) {
+        return a %= b;
+    }
+
+    friend constexpr fixed_integer operator&(fixed_integer a, const fixed_integer& b) {
+        return a &= b;
+    }
+
+    friend constexpr fixed_integer operator|(fixed_integer a, const fixed_integer& b) {
+        return a |= b;
+    }
+
+    friend constexpr fixed_integer operator^(fixed_integer a, const fixed_integer& b) {
+        return a ^= b;
+    }
+
+    friend constexpr fixed_integer operator<<(fixed_integer a, int b) {
+        return a <<= b;
+    }
+
+    friend constexpr fixed_integer operator>>(fixed_integer a, int b) {
+        return a >>= b;
+    }
+
+    friend constexpr bool operator==(const fixed_integer& a, const fixed_integer& b) {
+        return a.value == b.value;
+    }
+
+    friend constexpr std::strong_ordering operator<=>(const fixed_integer& a, const fixed_integer& b) {
+        if (a.is_negative() != b.is_negative()) {
+            return a.is_negative() ? std::strong_ordering::less : std::strong_ordering::greater;
+        }
+        return compare_magnitudes(a.value, b.value);
+    }
+
+    friend std::string to_string(const fixed_integer& a) {
+        return to_string(static_cast<big_integer>(a));
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const fixed_integer& a) {
+        return out << static_cast<big_integer>(a);
+    }
+
+private:
+    static constexpr size_t LIMB_BITS = std::numeric_limits<uint32_t>::digits;
+    static constexpr size_t LIMBS = Bits / LIMB_BITS;
+    static constexpr size_t UNROLLED_LIMBS = 16;
+
+    std::array<uint32_t, LIMBS> value{};
+
+    // Calls body(i) for i = 0, ..., COUNT - 1 in order, with i a std::integral_constant if the calls are unrolled.
+    template <size_t COUNT, typename Body>
+    static constexpr void unroll(Body&& body) {
+        if constexpr (LIMBS <= UNROLLED_LIMBS) {
+            [&]<size_t... I>(std::index_sequence<I...>) {
+                (body(std::integral_constant<size_t, I>()), ...);
+            }(std::make_index_sequence<COUNT>());
+        } else {
+            for (size_t i = 0; i < COUNT; ++i) {
+                body(i);
+            }
+        }
+    }
+
+    constexpr bool is_negative() const {
+        return Signed && (value[LIMBS - 1] >> (LIMB_BITS - 1)) != 0;
+    }
+
+    constexpr void negate() {
+        uint64_t carry = 1;
+        unroll<LIMBS>([&](auto i) {
+            uint64_t cur = static_cast<uint64_t>(~value[i]) + carry;
+            value[i] = static_cast<uint32_t>(cur);
+            carry = cur >> LIMB_BITS;
+        });
+    }
+
+    static constexpr std::strong_ordering compare_magnitudes(const std::array<uint32_t, LIMBS>& a,
+                                                             const std::array<uint32_t, LIMBS>& b) {
+        std::strong_ordering result = std::strong_ordering::equal;
+        unroll<LIMBS>([&](auto k) {
+            if (result == 0) {
+                result = a[LIMBS - 1 - k] <=> b[LIMBS - 1 - k];
+            }
+        });
+        return result;
+    }
+
+    static constexpr size_t significant_limbs(const std::array<uint32_t, LIMBS>& a) {
+        size_t n = LIMBS;
+        while (n > 0 && a[n - 1] == 0) {
+            --n;
+        }
+        return n;
+    }
+
+    // Quotient and remainder of the magnitudes with the signs of truncating division. Constant evaluation
+    // divides bit by bit, run time uses the long division of mpn on the significant limbs.
+    static constexpr void div_mod(const fixed_integer& a, const fixed_integer& b, fixed_integer& quotient,
+                                  fixed_integer& remainder) {
+        if (b == 0) {
+            throw std::invalid_argument("Division by zero");
+        }
+        bool quotient_negative = a.is_negative() != b.is_negative();
+        bool remainder_negative = a.is_negative();
+        fixed_integer x = a.is_negative() ? -a : a;
+        fixed_integer y = b.is_negative() ? -b : b;
+        std::array<uint32_t, LIMBS> q{};
+        std::array<uint32_t, LIMBS> r{};
+        size_t n = significant_limbs(x.value);
+        size_t m = significant_limbs(y.value);
+        if (n < m) {
+            r = x.value;
+        } else if (std::is_constant_evaluated()) {
+            for (size_t bit = n * LIMB_BITS; bit > 0; --bit) {
+                size_t i = (bit - 1) / LIMB_BITS;
+                uint32_t mask = uint32_t(1) << ((bit - 1) % LIMB_BITS);
+                unroll<LIMBS - 1>([&](auto k) {
+                    size_t j = LIMBS - k;
+                    r[j - 1] = (r[j - 1] << 1) | (r[j - 2] >> (LIMB_BITS - 1));
+                });
+                r[0] = (r[0] << 1) | ((x.value[i] & mask) != 0 ? 1 : 0);
+                if (compare_magnitudes(r, y.value) >= 0) {
+                    fixed_integer difference;
+                    difference.value = r;
+                    difference -= y;
+                    r = difference.value;
+                    q[i] |= mask;
+                }
+            }
+        } else if (m == 1) {
+            r[0] = mpn::divrem_1(std::span(q).first(n), std::span(x.value).first(n), y.value[0]);
+        } else {
+            mpn::divrem(std::span(q).first(n - m + 1), std::span(r).first(m), std::span(x.value).first(n),
+                        std::span(y.value).first(m));
+        }
+        quotient.value = q;
+        remainder.value = r;
+        if (quotient_negative) {
+            quotient.negate();
+        }
+        if (remainder_negative) {
+            remainder.negate();
+        }
+    }
+
+    template <size_t OtherBits, bool OtherSigned>
+    friend struct fixed_integer;
+};
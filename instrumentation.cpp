@@ -0,0 +1,141 @@
+#include "instrumentation.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+
+const std::array<const char*, ALGORITHM_TIERS> TIER_NAMES = {
+    "schoolbook_multiplication", "karatsuba_multiplication", "schoolbook_square", "karatsuba_square",
+    "short_division",            "long_division",            "quadratic_conversion", "subquadratic_conversion",
+};
+
+#ifdef BIGINT_INSTRUMENTATION
+
+struct atomic_tier_counters {
+    std::array<std::atomic<uint64_t>, SIZE_BUCKETS> calls;
+    std::atomic<uint64_t> nanoseconds;
+};
+
+std::array<atomic_tier_counters, ALGORITHM_TIERS> tiers;
+std::atomic<uint64_t> allocations;
+std::atomic<uint64_t> allocated_bytes;
+std::atomic<uint64_t> copied_bytes;
+std::atomic<uint64_t> leading_zero_shrinks;
+
+struct counting_memory_resource : std::pmr::memory_resource {
+public:
+    explicit counting_memory_resource(std::pmr::memory_resource* upstream) : upstream(upstream) {}
+
+private:
+    std::pmr::memory_resource* upstream;
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        return upstream->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        upstream->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        auto counting = dynamic_cast<const counting_memory_resource*>(&other);
+        return upstream->is_equal(counting != nullptr ? *counting->upstream : other);
+    }
+};
+
+// Counters only hold the address of their upstream, so one per address stays valid even when a resource
+// is destroyed and another one is created in its place.
+std::mutex counting_resources_mutex;
+std::unordered_map<std::pmr::memory_resource*, std::unique_ptr<counting_memory_resource>> counting_resources;
+
+thread_local std::pmr::memory_resource* cached_upstream = nullptr;
+thread_local std::pmr::memory_resource* cached_counting_resource = nullptr;
+
+#endif
+
+} // namespace
+
+instrumentation_snapshot get_instrumentation_snapshot() {
+    instrumentation_snapshot snapshot;
+#ifdef BIGINT_INSTRUMENTATION
+    for (size_t i = 0; i < ALGORITHM_TIERS; ++i) {
+        for (size_t j = 0; j < SIZE_BUCKETS; ++j) {
+            snapshot.tiers[i].calls[j] = tiers[i].calls[j].load(std::memory_order_relaxed);
+        }
+        snapshot.tiers[i].nanoseconds = tiers[i].nanoseconds.load(std::memory_order_relaxed);
+    }
+    snapshot.allocations = allocations.load(std::memory_order_relaxed);
+    snapshot.allocated_bytes = allocated_bytes.load(std::memory_order_relaxed);
+    snapshot.copied_bytes = copied_bytes.load(std::memory_order_relaxed);
+    snapshot.leading_zero_shrinks = leading_zero_shrinks.load(std::memory_order_relaxed);
+#endif
+    return snapshot;
+}
+
+void reset_instrumentation() {
+#ifdef BIGINT_INSTRUMENTATION
+    for (atomic_tier_counters& tier : tiers) {
+        for (std::atomic<uint64_t>& calls : tier.calls) {
+            calls.store(0, std::memory_order_relaxed);
+        }
+        tier.nanoseconds.store(0, std::memory_order_relaxed);
+    }
+    allocations.store(0, std::memory_order_relaxed);
+    allocated_bytes.store(0, std::memory_order_relaxed);
+    copied_bytes.store(0, std::memory_order_relaxed);
+    leading_zero_shrinks.store(0, std::memory_order_relaxed);
+#endif
+}
+
+const char* algorithm_tier_name(algorithm_tier tier) {
+    return TIER_NAMES[static_cast<size_t>(tier)];
+}
+
+#ifdef BIGINT_INSTRUMENTATION
+
+void instrumentation::count_copy(size_t limbs) {
+    copied_bytes.fetch_add(limbs * sizeof(uint32_t), std::memory_order_relaxed);
+}
+
+void instrumentation::count_shrink() {
+    leading_zero_shrinks.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::pmr::memory_resource* instrumentation::counting_resource(std::pmr::memory_resource* upstream) {
+    if (upstream != cached_upstream) {
+        std::lock_guard<std::mutex> lock(counting_resources_mutex);
+        std::unique_ptr<counting_memory_resource>& counter = counting_resources[upstream];
+        if (counter == nullptr) {
+            counter = std::make_unique<counting_memory_resource>(upstream);
+        }
+        cached_upstream = upstream;
+        cached_counting_resource = counter.get();
+    }
+    return cached_counting_resource;
+}
+
+instrumentation::timed_operation::timed_operation(algorithm_tier tier, size_t limbs)
+        : tier(tier), start(std::chrono::steady_clock::now()) {
+    size_t bucket = std::min<size_t>(std::bit_width(limbs), SIZE_BUCKETS - 1);
+    tiers[static_cast<size_t>(tier)].calls[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+instrumentation::timed_operation::~timed_operation() {
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    uint64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    tiers[static_cast<size_t>(tier)].nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+}
+
+#endif
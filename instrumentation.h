@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+// Opt-in counters of the work done by the library, compiled in only when BIGINT_INSTRUMENTATION is defined
+// (the CMake option of the same name). Without it every hook below is empty and snapshots stay zero.
+
+enum class algorithm_tier {
+    schoolbook_multiplication,
+    karatsuba_multiplication,
+    schoolbook_square,
+    karatsuba_square,
+    short_division,
+    long_division,
+    quadratic_conversion,
+    subquadratic_conversion,
+};
+
+const size_t ALGORITHM_TIERS = 8;
+const size_t SIZE_BUCKETS = 32;
+
+struct tier_counters {
+    // calls[i] counts operations whose longest operand has bit_width(limbs) == i, the last bucket also
+    // everything longer.
+    std::array<uint64_t, SIZE_BUCKETS> calls{};
+    // Wall time of the operations, including the operations of other tiers they run internally.
+    uint64_t nanoseconds = 0;
+};
+
+struct instrumentation_snapshot {
+    // Indexed by algorithm_tier.
+    std::array<tier_counters, ALGORITHM_TIERS> tiers{};
+    // Limb buffers obtained by numbers from their memory resources.
+    uint64_t allocations = 0;
+    uint64_t allocated_bytes = 0;
+    // Limbs copied from one number into another, by copies and by swaps across memory resources.
+    uint64_t copied_bytes = 0;
+    // Calls of skip_leading_zeros that dropped at least one limb.
+    uint64_t leading_zero_shrinks = 0;
+};
+
+constexpr bool instrumentation_enabled() {
+#ifdef BIGINT_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Counters are updated atomically, so a snapshot taken during a computation is consistent per counter only.
+instrumentation_snapshot get_instrumentation_snapshot();
+void reset_instrumentation();
+// snake_case name of the tier for exporting.
+const char* algorithm_tier_name(algorithm_tier tier);
+
+// Hooks for the library itself.
+namespace instrumentation {
+
+#ifdef BIGINT_INSTRUMENTATION
+
+void count_copy(size_t limbs);
+void count_shrink();
+// A resource that forwards to upstream and counts its allocations; one per upstream, never destroyed.
+std::pmr::memory_resource* counting_resource(std::pmr::memory_resource* upstream);
+
+// Counts one operation of the tier and adds its time when the scope ends.
+struct timed_operation {
+public:
+    timed_operation(algorithm_tier tier, size_t limbs);
+    timed_operation(const timed_operation& other) = delete;
+    ~timed_operation();
+
+    timed_operation& operator=(const timed_operation& other) = delete;
+
+private:
+    algorithm_tier tier;
+    std::chrono::steady_clock::time_point start;
+};
+
+#else
+
+inline void count_copy(size_t) {}
+
+inline void count_shrink() {}
+
+inline std::pmr::memory_resource* counting_resource(std::pmr::memory_resource* upstream) {
+    return upstream;
+}
+
+struct timed_operation {
+public:
+    timed_operation(algorithm_tier, size_t) {}
+};
+
+#endif
+
+} // namespace instrumentation
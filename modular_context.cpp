@@ -0,0 +1,198 @@
+#include "modular_context.h"
+#include "mpn.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+
+mod_big_integer::mod_big_integer() : value(big_integer_memory_resource()) {}
+
+mod_big_integer::mod_big_integer(const mod_big_integer& other) : value(other.value, big_integer_memory_resource()) {}
+
+mod_big_integer::~mod_big_integer() = default;
+
+mod_big_integer& mod_big_integer::operator=(const mod_big_integer& other) = default;
+
+bool operator==(const mod_big_integer& a, const mod_big_integer& b) {
+    return a.value == b.value;
+}
+
+bool operator!=(const mod_big_integer& a, const mod_big_integer& b) {
+    return !(a == b);
+}
+
+modular_context::modular_context(const big_integer& modulus)
+        : mod(modulus), mod_value(big_integer_memory_resource()), one_value(big_integer_memory_resource()),
+          r_squared(big_integer_memory_resource()), scratch(big_integer_memory_resource()),
+          base(big_integer_memory_resource()) {
+    if (modulus <= 1 || modulus.limbs()[0] % 2 == 0) {
+        throw std::invalid_argument("Modulus must be odd and greater than one");
+    }
+    std::span<const uint32_t> digits = modulus.limbs();
+    mod_value.assign(digits.begin(), digits.end());
+    while (mod_value.size() > 1 && mod_value.back() == 0) {
+        mod_value.pop_back();
+    }
+    size_t n = mod_value.size();
+
+    // Newton iteration for m^-1 mod 2^32: every odd m is its own inverse modulo 8,
+    // and each step doubles the number of correct low bits.
+    uint32_t m0 = mod_value[0];
+    uint32_t inv = m0;
+    for (int i = 0; i < 4; ++i) {
+        inv *= 2 - m0 * inv;
+    }
+    inverse = 0 - inv;
+
+    scratch.resize(n + 2);
+    base.resize(n);
+    // The only long division: R^2 mod m turns any reduced residue into Montgomery form with one reduce.
+    big_integer r = big_integer(1) << static_cast<int>(2 * std::numeric_limits<uint32_t>::digits * n);
+    r %= mod;
+    std::span<const uint32_t> r_digits = r.limbs();
+    r_squared.assign(r_digits.begin(), r_digits.end());
+    r_squared.resize(n, 0);
+    one_value = to_montgomery(1).value;
+}
+
+const big_integer& modular_context::modulus() const {
+    return mod;
+}
+
+size_t modular_context::size() const {
+    return mod_value.size();
+}
+
+mod_big_integer modular_context::to_montgomery(const big_integer& a) {
+    std::span<const uint32_t> digits = a.limbs();
+    big_integer r;
+    if (a < 0 || a >= mod) {
+        r = a % mod;
+        if (r < 0) {
+            r += mod;
+        }
+        digits = r.limbs();
+    }
+    std::fill(std::copy(digits.begin(), digits.end(), base.begin()), base.end(), 0);
+    reduce(base.data(), r_squared.data());
+    mod_big_integer result;
+    store(result);
+    return result;
+}
+
+big_integer modular_context::from_montgomery(const mod_big_integer& a) {
+    std::fill(base.begin(), base.end(), 0);
+    base[0] = 1;
+    reduce(a.value.data(), base.data());
+    big_integer result;
+    result.value.assign(scratch.begin(), scratch.begin() + static_cast<std::ptrdiff_t>(mod_value.size()));
+    result.skip_leading_zeros();
+    return result;
+}
+
+mod_big_integer modular_context::zero() const {
+    mod_big_integer result;
+    result.value.resize(mod_value.size(), 0);
+    return result;
+}
+
+mod_big_integer modular_context::one() const {
+    mod_big_integer result;
+    result.value = one_value;
+    return result;
+}
+
+void modular_context::add(mod_big_integer& result, const mod_big_integer& a, const mod_big_integer& b) const {
+    result.value.resize(mod_value.size());
+    if (mpn::add_n(result.value, a.value, b.value) != 0 || is_not_less_than_modulus(result.value.data())) {
+        mpn::sub_n(result.value, result.value, mod_value);
+    }
+}
+
+void modular_context::sub(mod_big_integer& result, const mod_big_integer& a, const mod_big_integer& b) const {
+    result.value.resize(mod_value.size());
+    if (mpn::sub_n(result.value, a.value, b.value) != 0) {
+        mpn::add_n(result.value, result.value, mod_value);
+    }
+}
+
+void modular_context::mul(mod_big_integer& result, const mod_big_integer& a, const mod_big_integer& b) {
+    reduce(a.value.data(), b.value.data());
+    store(result);
+}
+
+void modular_context::sqr(mod_big_integer& result, const mod_big_integer& a) {
+    reduce(a.value.data(), a.value.data());
+    store(result);
+}
+
+void modular_context::pow(mod_big_integer& result, const mod_big_integer& a, const big_integer& exponent) {
+    if (exponent < 0) {
+        throw std::invalid_argument("Exponent can't be negative");
+    }
+    std::copy(a.value.begin(), a.value.end(), base.begin());
+    result.value = one_value;
+    std::span<const uint32_t> digits = exponent.limbs();
+    bool started = false;
+    for (size_t i = digits.size(); i > 0; --i) {
+        for (int bit = std::numeric_limits<uint32_t>::digits - 1; bit >= 0; --bit) {
+            if (started) {
+                reduce(result.value.data(), result.value.data());
+                store(result);
+            }
+            if ((digits[i - 1] >> bit) & 1) {
+                reduce(result.value.data(), base.data());
+                store(result);
+                started = true;
+            }
+        }
+    }
+}
+
+// Coarsely integrated operand scanning: interleaves one row of a * b with one word of reduction,
+// leaving a * b * 2^(-32n) mod m in the low n limbs of scratch.
+void modular_context::reduce(const uint32_t* a, const uint32_t* b) {
+    size_t n = mod_value.size();
+    uint32_t* t = scratch.data();
+    std::fill(t, t + n + 2, 0);
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t b_digit = b[i];
+        uint64_t carry = 0;
+        for (size_t j = 0; j < n; ++j) {
+            uint64_t cur = t[j] + static_cast<uint64_t>(a[j]) * b_digit + carry;
+            t[j] = static_cast<uint32_t>(cur);
+            carry = cur >> std::numeric_limits<uint32_t>::digits;
+        }
+        uint64_t cur = static_cast<uint64_t>(t[n]) + carry;
+        t[n] = static_cast<uint32_t>(cur);
+        t[n + 1] = static_cast<uint32_t>(cur >> std::numeric_limits<uint32_t>::digits);
+
+        uint64_t m = static_cast<uint32_t>(t[0] * inverse);
+        cur = t[0] + m * mod_value[0];
+        carry = cur >> std::numeric_limits<uint32_t>::digits;
+        for (size_t j = 1; j < n; ++j) {
+            cur = t[j] + m * mod_value[j] + carry;
+            t[j - 1] = static_cast<uint32_t>(cur);
+            carry = cur >> std::numeric_limits<uint32_t>::digits;
+        }
+        cur = static_cast<uint64_t>(t[n]) + carry;
+        t[n - 1] = static_cast<uint32_t>(cur);
+        t[n] = t[n + 1] + static_cast<uint32_t>(cur >> std::numeric_limits<uint32_t>::digits);
+    }
+    if (t[n] != 0 || is_not_less_than_modulus(t)) {
+        std::span<uint32_t> low(t, n);
+        mpn::sub_n(low, low, mod_value);
+    }
+}
+
+void modular_context::store(mod_big_integer& result) const {
+    result.value.resize(mod_value.size());
+    std::copy(scratch.begin(), scratch.begin() + static_cast<std::ptrdiff_t>(mod_value.size()), result.value.begin());
+}
+
+bool modular_context::is_not_less_than_modulus(const uint32_t* a) const {
+    return mpn::cmp(std::span(a, mod_value.size()), mod_value) >= 0;
+}
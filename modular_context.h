@@ -0,0 +1,68 @@
+#pragma once
+
+#include "big_integer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+// Residue held in Montgomery form. It is only meaningful together with the modular_context that created it.
+struct mod_big_integer {
+public:
+    mod_big_integer();
+    mod_big_integer(const mod_big_integer& other);
+    ~mod_big_integer();
+
+    mod_big_integer& operator=(const mod_big_integer& other);
+
+    friend bool operator==(const mod_big_integer& a, const mod_big_integer& b);
+    friend bool operator!=(const mod_big_integer& a, const mod_big_integer& b);
+
+private:
+    // Allocated from big_integer_memory_resource() like the limbs of a big_integer.
+    std::pmr::vector<uint32_t> value;
+
+    friend struct modular_context;
+};
+
+bool operator==(const mod_big_integer& a, const mod_big_integer& b);
+bool operator!=(const mod_big_integer& a, const mod_big_integer& b);
+
+// Montgomery arithmetic modulo a fixed odd modulus. All constants, including R^2 mod m for R = 2^(32 size()),
+// are computed once in the constructor and every residue occupies exactly size() limbs, so add, sub, mul,
+// sqr and pow never divide and never allocate once their result operand has been created by this context.
+// to_montgomery divides only to reduce arguments outside [0, m).
+// A context owns its scratch buffer and must not be shared between threads.
+struct modular_context {
+public:
+    explicit modular_context(const big_integer& modulus);
+
+    const big_integer& modulus() const;
+    size_t size() const;
+
+    mod_big_integer to_montgomery(const big_integer& a);
+    big_integer from_montgomery(const mod_big_integer& a);
+
+    mod_big_integer zero() const;
+    mod_big_integer one() const;
+
+    void add(mod_big_integer& result, const mod_big_integer& a, const mod_big_integer& b) const;
+    void sub(mod_big_integer& result, const mod_big_integer& a, const mod_big_integer& b) const;
+    void mul(mod_big_integer& result, const mod_big_integer& a, const mod_big_integer& b);
+    void sqr(mod_big_integer& result, const mod_big_integer& a);
+    void pow(mod_big_integer& result, const mod_big_integer& a, const big_integer& exponent);
+
+private:
+    big_integer mod;
+    std::pmr::vector<uint32_t> mod_value;
+    std::pmr::vector<uint32_t> one_value;
+    std::pmr::vector<uint32_t> r_squared;
+    uint32_t inverse = 0;
+    std::pmr::vector<uint32_t> scratch;
+    std::pmr::vector<uint32_t> base;
+
+    void reduce(const uint32_t* a, const uint32_t* b);
+    void store(mod_big_integer& result) const;
+    bool is_not_less_than_modulus(const uint32_t* a) const;
+};
@@ -0,0 +1,359 @@
+#include "mpn.h"
+#include "big_integer.h"
+#include "instrumentation.h"
+#include "thread_pool.h"
+#include "workspace.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+
+namespace {
+
+const int LIMB_BITS = std::numeric_limits<uint32_t>::digits;
+
+void mul_schoolbook(std::span<uint32_t> out, std::span<const uint32_t> a, std::span<const uint32_t> b) {
+    std::fill(out.begin(), out.end(), 0);
+    for (size_t i = 0; i < b.size(); ++i) {
+        out[i + a.size()] = mpn::addmul_1(out.subspan(i, a.size()), a, b[i]);
+    }
+}
+
+// Every product a[i] * a[j] with i < j is accumulated once and doubled, then the squares a[i]^2 are added.
+void sqr_schoolbook(std::span<uint32_t> out, std::span<const uint32_t> a) {
+    size_t n = a.size();
+    std::fill(out.begin(), out.end(), 0);
+    for (size_t i = 0; i + 1 < n; ++i) {
+        out[i + n] = mpn::addmul_1(out.subspan(2 * i + 1, n - i - 1), a.subspan(i + 1), a[i]);
+    }
+    mpn::lshift(out, out, 1);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t square = static_cast<uint64_t>(a[i]) * a[i];
+        uint64_t low = static_cast<uint64_t>(out[2 * i]) + static_cast<uint32_t>(square) + carry;
+        out[2 * i] = static_cast<uint32_t>(low);
+        uint64_t high = static_cast<uint64_t>(out[2 * i + 1]) + (square >> LIMB_BITS) + (low >> LIMB_BITS);
+        out[2 * i + 1] = static_cast<uint32_t>(high);
+        carry = high >> LIMB_BITS;
+    }
+}
+
+// Read once per top-level call from algorithm_thresholds and parallel_options.
+struct recursion_cutoffs {
+    size_t karatsuba;
+    size_t parallel;
+};
+
+// out = a * b for a.size() >= b.size(). An operand much longer than the other is multiplied in chunks of the
+// shorter length, so both halves of every Karatsuba split are populated. With a pool, the three subproducts
+// of large operands are scheduled as tasks; they write disjoint buffers, so the result does not depend on
+// timing.
+void mul_recursive(std::span<uint32_t> out, std::span<const uint32_t> a, std::span<const uint32_t> b,
+                   thread_pool* workers, const recursion_cutoffs& cutoffs) {
+    size_t n = a.size();
+    size_t m = b.size();
+    if (m < cutoffs.karatsuba) {
+        mul_schoolbook(out, a, b);
+        return;
+    }
+    size_t h = (n + 1) / 2;
+    workspace_frame frame;
+    if (m <= h) {
+        std::fill(out.begin(), out.end(), 0);
+        std::span<uint32_t> chunk(frame.allocate(2 * m), 2 * m);
+        for (size_t offset = 0; offset < n; offset += m) {
+            size_t length = std::min(m, n - offset);
+            mul_recursive(chunk.first(m + length), b, a.subspan(offset, length), workers, cutoffs);
+            mpn::add(out.subspan(offset), out.subspan(offset), chunk.first(m + length));
+        }
+        return;
+    }
+    std::span<uint32_t> a_sum(frame.allocate(h + 1), h + 1);
+    std::span<uint32_t> b_sum(frame.allocate(h + 1), h + 1);
+    std::span<uint32_t> middle(frame.allocate(2 * h + 2), 2 * h + 2);
+    a_sum[h] = mpn::add(a_sum.first(h), a.first(h), a.subspan(h));
+    b_sum[h] = mpn::add(b_sum.first(h), b.first(h), b.subspan(h));
+
+    auto low = [&] { mul_recursive(out.first(2 * h), a.first(h), b.first(h), workers, cutoffs); };
+    auto high = [&] { mul_recursive(out.subspan(2 * h), a.subspan(h), b.subspan(h), workers, cutoffs); };
+    auto mid = [&] { mul_recursive(middle, a_sum, b_sum, workers, cutoffs); };
+    if (workers != nullptr && m >= cutoffs.parallel) {
+        task_group group(*workers);
+        group.run(low);
+        group.run(high);
+        mid();
+        group.wait();
+    } else {
+        low();
+        high();
+        mid();
+    }
+    mpn::sub(middle, middle, out.first(2 * h));
+    mpn::sub(middle, middle, out.subspan(2 * h));
+    std::span<uint32_t> upper = out.subspan(h);
+    mpn::add(upper, upper, middle.first(std::min(middle.size(), upper.size())));
+}
+
+void sqr_recursive(std::span<uint32_t> out, std::span<const uint32_t> a, thread_pool* workers,
+                   const recursion_cutoffs& cutoffs) {
+    size_t n = a.size();
+    if (n < cutoffs.karatsuba) {
+        sqr_schoolbook(out, a);
+        return;
+    }
+    size_t h = (n + 1) / 2;
+    workspace_frame frame;
+    std::span<uint32_t> a_sum(frame.allocate(h + 1), h + 1);
+    std::span<uint32_t> middle(frame.allocate(2 * h + 2), 2 * h + 2);
+    a_sum[h] = mpn::add(a_sum.first(h), a.first(h), a.subspan(h));
+
+    auto low = [&] { sqr_recursive(out.first(2 * h), a.first(h), workers, cutoffs); };
+    auto high = [&] { sqr_recursive(out.subspan(2 * h), a.subspan(h), workers, cutoffs); };
+    auto mid = [&] { sqr_recursive(middle, a_sum, workers, cutoffs); };
+    if (workers != nullptr && n >= cutoffs.parallel) {
+        task_group group(*workers);
+        group.run(low);
+        group.run(high);
+        mid();
+        group.wait();
+    } else {
+        low();
+        high();
+        mid();
+    }
+    mpn::sub(middle, middle, out.first(2 * h));
+    mpn::sub(middle, middle, out.subspan(2 * h));
+    std::span<uint32_t> upper = out.subspan(h);
+    mpn::add(upper, upper, middle.first(std::min(middle.size(), upper.size())));
+}
+
+} // namespace
+
+namespace mpn {
+
+uint32_t add_n(std::span<uint32_t> out, std::span<const uint32_t> a, std::span<const uint32_t> b) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        uint64_t cur = static_cast<uint64_t>(a[i]) + b[i] + carry;
+        out[i] = static_cast<uint32_t>(cur);
+        carry = cur >> LIMB_BITS;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+uint32_t sub_n(std::span<uint32_t> out, std::span<const uint32_t> a, std::span<const uint32_t> b) {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        uint64_t cur = static_cast<uint64_t>(a[i]) - b[i] - borrow;
+        out[i] = static_cast<uint32_t>(cur);
+        borrow = cur >> (2 * LIMB_BITS - 1);
+    }
+    return static_cast<uint32_t>(borrow);
+}
+
+uint32_t add(std::span<uint32_t> out, std::span<const uint32_t> a, std::span<const uint32_t> b) {
+    uint32_t carry = add_n(out.first(b.size()), a.first(b.size()), b);
+    return add_1(out.subspan(b.size()), a.subspan(b.size()), carry);
+}
+
+uint32_t sub(std::span<uint32_t> out, std::span<const uint32_t> a, std::span<const uint32_t> b) {
+    uint32_t borrow = sub_n(out.first(b.size()), a.first(b.size()), b);
+    return sub_1(out.subspan(b.size()), a.subspan(b.size()), borrow);
+}
+
+// The carry stops early, and the rest of a is only copied when out is a different span.
+uint32_t add_1(std::span<uint32_t> out, std::span<const uint32_t> a, uint32_t b) {
+    uint64_t carry = b;
+    size_t i = 0;
+    for (; i < a.size() && carry != 0; ++i) {
+        uint64_t cur = static_cast<uint64_t>(a[i]) + carry;
+        out[i] = static_cast<uint32_t>(cur);
+        carry = cur >> LIMB_BITS;
+    }
+    if (out.data() != a.data()) {
+        std::copy(a.begin() + i, a.end(), out.begin() + i);
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+uint32_t sub_1(std::span<uint32_t> out, std::span<const uint32_t> a, uint32_t b) {
+    uint64_t borrow = b;
+    size_t i = 0;
+    for (; i < a.size() && borrow != 0; ++i) {
+        uint64_t cur = static_cast<uint64_t>(a[i]) - borrow;
+        out[i] = static_cast<uint32_t>(cur);
+        borrow = cur >> (2 * LIMB_BITS - 1);
+    }
+    if (out.data() != a.data()) {
+        std::copy(a.begin() + i, a.end(), out.begin() + i);
+    }
+    return static_cast<uint32_t>(borrow);
+}
+
+uint32_t mul_1(std::span<uint32_t> out, std::span<const uint32_t> a, uint32_t b) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        uint64_t cur = static_cast<uint64_t>(a[i]) * b + carry;
+        out[i] = static_cast<uint32_t>(cur);
+        carry = cur >> LIMB_BITS;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+uint32_t addmul_1(std::span<uint32_t> out, std::span<const uint32_t> a, uint32_t b) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        uint64_t cur = static_cast<uint64_t>(a[i]) * b + out[i] + carry;
+        out[i] = static_cast<uint32_t>(cur);
+        carry = cur >> LIMB_BITS;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+uint32_t submul_1(std::span<uint32_t> out, std::span<const uint32_t> a, uint32_t b) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        uint64_t product = static_cast<uint64_t>(a[i]) * b + carry;
+        uint32_t low = static_cast<uint32_t>(product);
+        carry = (product >> LIMB_BITS) + (out[i] < low ? 1 : 0);
+        out[i] -= low;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+void mul(std::span<uint32_t> out, std::span<const uint32_t> a, std::span<const uint32_t> b, thread_pool* workers) {
+    if (a.size() < b.size()) {
+        std::swap(a, b);
+    }
+    if (b.empty()) {
+        std::fill(out.begin(), out.end(), 0);
+        return;
+    }
+    recursion_cutoffs cutoffs = {get_algorithm_thresholds().karatsuba_multiplication,
+                                 workers != nullptr ? get_parallel_options().multiplication_cutoff : 0};
+    instrumentation::timed_operation operation(b.size() < cutoffs.karatsuba
+                                                   ? algorithm_tier::schoolbook_multiplication
+                                                   : algorithm_tier::karatsuba_multiplication,
+                                               a.size());
+    mul_recursive(out, a, b, workers, cutoffs);
+}
+
+void sqr(std::span<uint32_t> out, std::span<const uint32_t> a, thread_pool* workers) {
+    recursion_cutoffs cutoffs = {get_algorithm_thresholds().karatsuba_square,
+                                 workers != nullptr ? get_parallel_options().multiplication_cutoff : 0};
+    instrumentation::timed_operation operation(
+        a.size() < cutoffs.karatsuba ? algorithm_tier::schoolbook_square : algorithm_tier::karatsuba_square, a.size());
+    sqr_recursive(out, a, workers, cutoffs);
+}
+
+// Knuth's algorithm D on copies shifted so that the top bit of the divisor is set: the quotient digit
+// estimated from the top two limbs of the window and of the divisor is then at most one too large.
+void divrem(std::span<uint32_t> q, std::span<uint32_t> r, std::span<const uint32_t> a, std::span<const uint32_t> b) {
+    size_t n = a.size();
+    size_t m = b.size();
+    if (m == 1) {
+        r[0] = divrem_1(q, a, b[0]);
+        return;
+    }
+    instrumentation::timed_operation operation(algorithm_tier::long_division, n);
+    workspace_frame frame;
+    std::span<uint32_t> u(frame.allocate(n + 1), n + 1);
+    std::span<uint32_t> v(frame.allocate(m), m);
+    int shift = std::countl_zero(b[m - 1]);
+    u[n] = lshift(u.first(n), a, shift);
+    lshift(v, b, shift);
+    uint64_t top = v[m - 1];
+    uint64_t second = v[m - 2];
+    for (size_t j = n - m + 1; j > 0; --j) {
+        std::span<uint32_t> window = u.subspan(j - 1, m + 1);
+        uint64_t numerator = (static_cast<uint64_t>(window[m]) << LIMB_BITS) | window[m - 1];
+        uint64_t trial = numerator / top;
+        uint64_t rest = numerator % top;
+        while (trial > UINT32_MAX || trial * second > ((rest << LIMB_BITS) | window[m - 2])) {
+            --trial;
+            rest += top;
+            if (rest > UINT32_MAX) {
+                break;
+            }
+        }
+        uint32_t borrow = submul_1(window.first(m), v, static_cast<uint32_t>(trial));
+        if (window[m] < borrow) {
+            --trial;
+            add_n(window.first(m), window.first(m), v);
+        }
+        window[m] = 0;
+        q[j - 1] = static_cast<uint32_t>(trial);
+    }
+    rshift(r, u.first(m), shift);
+}
+
+uint32_t divrem_1(std::span<uint32_t> out, std::span<const uint32_t> a, uint32_t b) {
+    instrumentation::timed_operation operation(algorithm_tier::short_division, a.size());
+    uint64_t remainder = 0;
+    for (size_t i = a.size(); i > 0; --i) {
+        uint64_t cur = (remainder << LIMB_BITS) | a[i - 1];
+        out[i - 1] = static_cast<uint32_t>(cur / b);
+        remainder = cur % b;
+    }
+    return static_cast<uint32_t>(remainder);
+}
+
+uint32_t mod_1(std::span<const uint32_t> a, uint32_t b) {
+    instrumentation::timed_operation operation(algorithm_tier::short_division, a.size());
+    uint64_t remainder = 0;
+    for (size_t i = a.size(); i > 0; --i) {
+        remainder = ((remainder << LIMB_BITS) | a[i - 1]) % b;
+    }
+    return static_cast<uint32_t>(remainder);
+}
+
+// Runs from the top limb down, so that out may be shifted towards higher addresses in place.
+uint32_t lshift(std::span<uint32_t> out, std::span<const uint32_t> a, int shift) {
+    size_t n = a.size();
+    if (shift == 0) {
+        std::copy_backward(a.begin(), a.end(), out.begin() + n);
+        return 0;
+    }
+    if (n == 0) {
+        return 0;
+    }
+    uint32_t result = a[n - 1] >> (LIMB_BITS - shift);
+    for (size_t i = n - 1; i > 0; --i) {
+        out[i] = (a[i] << shift) | (a[i - 1] >> (LIMB_BITS - shift));
+    }
+    out[0] = a[0] << shift;
+    return result;
+}
+
+// Runs from the bottom limb up, so that out may be shifted towards lower addresses in place.
+uint32_t rshift(std::span<uint32_t> out, std::span<const uint32_t> a, int shift) {
+    size_t n = a.size();
+    if (shift == 0) {
+        std::copy(a.begin(), a.end(), out.begin());
+        return 0;
+    }
+    if (n == 0) {
+        return 0;
+    }
+    uint32_t result = a[0] << (LIMB_BITS - shift);
+    for (size_t i = 0; i + 1 < n; ++i) {
+        out[i] = (a[i] >> shift) | (a[i + 1] << (LIMB_BITS - shift));
+    }
+    out[n - 1] = a[n - 1] >> shift;
+    return result;
+}
+
+int cmp(std::span<const uint32_t> a, std::span<const uint32_t> b) {
+    for (size_t i = a.size(); i > 0; --i) {
+        if (a[i - 1] != b[i - 1]) {
+            return a[i - 1] < b[i - 1] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+} // namespace mpn
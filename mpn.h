@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+struct thread_pool;
+
+// Arithmetic on little-endian limb spans that writes into caller memory and returns carries instead of
+// growing anything. Nothing here allocates except scratch limbs of the calling thread (see workspace.h).
+// An output may be the same span as an input unless stated otherwise, but must not partially overlap it.
+namespace mpn {
+
+// out = a + b for out.size() == a.size() == b.size(), returns the carry.
+uint32_t add_n(std::span<uint32_t> out, std::span<const uint32_t> a, std::span<const uint32_t> b);
+// out = a - b for out.size() == a.size() == b.size(), returns the borrow.
+uint32_t sub_n(std::span<uint32_t> out, std::span<const uint32_t> a, std::span<const uint32_t> b);
+// out = a + b for out.size() == a.size() >= b.size(), returns the carry.
+uint32_t add(std::span<uint32_t> out, std::span<const uint32_t> a, std::span<const uint32_t> b);
+// out = a - b for out.size() == a.size() >= b.size(), returns the borrow.
+uint32_t sub(std::span<uint32_t> out, std::span<const uint32_t> a, std::span<const uint32_t> b);
+// out = a + b for out.size() == a.size(), returns the carry, which is b itself for empty spans.
+uint32_t add_1(std::span<uint32_t> out, std::span<const uint32_t> a, uint32_t b);
+// out = a - b for out.size() == a.size(), returns the borrow.
+uint32_t sub_1(std::span<uint32_t> out, std::span<const uint32_t> a, uint32_t b);
+
+// out = a * b for out.size() == a.size(), returns the high limb.
+uint32_t mul_1(std::span<uint32_t> out, std::span<const uint32_t> a, uint32_t b);
+// out += a * b for out.size() == a.size(), returns the high limb.
+uint32_t addmul_1(std::span<uint32_t> out, std::span<const uint32_t> a, uint32_t b);
+// out -= a * b for out.size() == a.size(), returns the limb to be borrowed from above.
+uint32_t submul_1(std::span<uint32_t> out, std::span<const uint32_t> a, uint32_t b);
+// out = a * b for out.size() == a.size() + b.size(); out must not overlap the inputs. With a pool, the
+// Karatsuba subproducts of large operands run as tasks on it.
+void mul(std::span<uint32_t> out, std::span<const uint32_t> a, std::span<const uint32_t> b,
+         thread_pool* workers = nullptr);
+// out = a * a for out.size() == 2 * a.size(); out must not overlap a.
+void sqr(std::span<uint32_t> out, std::span<const uint32_t> a, thread_pool* workers = nullptr);
+
+// q = a / b and r = a % b for q.size() == a.size() - b.size() + 1, r.size() == b.size() and a non-zero
+// top limb of b; q and r must not overlap the inputs.
+void divrem(std::span<uint32_t> q, std::span<uint32_t> r, std::span<const uint32_t> a, std::span<const uint32_t> b);
+// out = a / b for out.size() == a.size(), returns a % b.
+uint32_t divrem_1(std::span<uint32_t> out, std::span<const uint32_t> a, uint32_t b);
+uint32_t mod_1(std::span<const uint32_t> a, uint32_t b);
+
+// out = a << shift for out.size() == a.size() and shift < 32, returns the bits shifted out of the top.
+// out may also start above a in the same buffer.
+uint32_t lshift(std::span<uint32_t> out, std::span<const uint32_t> a, int shift);
+// out = a >> shift for out.size() == a.size() and shift < 32, returns the bits shifted out of the bottom
+// in the high bits of the result. out may also start below a in the same buffer.
+uint32_t rshift(std::span<uint32_t> out, std::span<const uint32_t> a, int shift);
+
+// -1, 0 or 1 for a.size() == b.size().
+int cmp(std::span<const uint32_t> a, std::span<const uint32_t> b);
+
+} // namespace mpn
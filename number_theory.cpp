@@ -0,0 +1,736 @@
+#include "number_theory.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct lehmer_cofactors {
+    uint64_t u0 = 0;
+    uint64_t u1 = 1;
+    uint64_t v0 = 0;
+    uint64_t v1 = 0;
+    bool even = false;
+};
+
+uint32_t digit_at(const std::pmr::vector<uint32_t>& a, size_t i) {
+    return i < a.size() ? a[i] : 0;
+}
+
+// Top 64 bits of a, taken at the position of the leading limb of `top` so that both operands stay aligned.
+uint64_t leading_bits(const std::pmr::vector<uint32_t>& a, size_t top, int shift) {
+    uint64_t high = (static_cast<uint64_t>(digit_at(a, top)) << std::numeric_limits<uint32_t>::digits) |
+                    digit_at(a, top - 1);
+    if (shift == 0) {
+        return high;
+    }
+    uint32_t low = top >= 2 ? digit_at(a, top - 2) : 0;
+    return (high << shift) | (low >> (std::numeric_limits<uint32_t>::digits - shift));
+}
+
+// Runs Euclid on the leading double digits of a >= b with Collins' stopping condition, so that the
+// returned cosequence reproduces the first quotients of the full-size Euclidean algorithm.
+// All cofactors are kept within one limb for the linear combination kernel.
+lehmer_cofactors lehmer_simulate(const std::pmr::vector<uint32_t>& a, const std::pmr::vector<uint32_t>& b) {
+    size_t top = a.size() - 1;
+    int shift = std::countl_zero(a.back());
+    uint64_t a1 = leading_bits(a, top, shift);
+    uint64_t a2 = leading_bits(b, top, shift);
+
+    lehmer_cofactors result;
+    uint64_t u2 = 0;
+    uint64_t v2 = 1;
+    while (a2 >= v2 && a1 - a2 >= result.v1 + v2) {
+        uint64_t q = a1 / a2;
+        if (q > UINT32_MAX || q * u2 > UINT32_MAX - result.u1 || q * v2 > UINT32_MAX - result.v1) {
+            break;
+        }
+        uint64_t r = a1 % a2;
+        a1 = a2;
+        a2 = r;
+        uint64_t next_u = result.u1 + q * u2;
+        uint64_t next_v = result.v1 + q * v2;
+        result.u0 = result.u1;
+        result.u1 = u2;
+        u2 = next_u;
+        result.v0 = result.v1;
+        result.v1 = v2;
+        v2 = next_v;
+        result.even = !result.even;
+    }
+    return result;
+}
+
+// result = cx * x - cy * y, which the caller guarantees to be non-negative.
+void linear_combination(std::pmr::vector<uint32_t>& result, const std::pmr::vector<uint32_t>& x, uint64_t cx,
+                        const std::pmr::vector<uint32_t>& y, uint64_t cy) {
+    size_t size = std::max(x.size(), y.size());
+    result.resize(size);
+    uint64_t positive_carry = 0;
+    uint64_t negative_carry = 0;
+    bool borrow = false;
+    for (size_t i = 0; i < size; ++i) {
+        uint64_t positive = cx * digit_at(x, i) + positive_carry;
+        uint64_t negative = cy * digit_at(y, i) + negative_carry;
+        positive_carry = positive >> std::numeric_limits<uint32_t>::digits;
+        negative_carry = negative >> std::numeric_limits<uint32_t>::digits;
+        int64_t digit = static_cast<int64_t>(static_cast<uint32_t>(positive)) -
+                        static_cast<int64_t>(static_cast<uint32_t>(negative)) - (borrow ? 1 : 0);
+        borrow = digit < 0;
+        result[i] = static_cast<uint32_t>(digit);
+    }
+    while (result.size() > 1 && result.back() == 0) {
+        result.pop_back();
+    }
+}
+
+void lehmer_update(std::pmr::vector<uint32_t>& a, std::pmr::vector<uint32_t>& b, const lehmer_cofactors& c,
+                   std::pmr::vector<uint32_t>& next_a, std::pmr::vector<uint32_t>& next_b) {
+    if (c.even) {
+        linear_combination(next_a, a, c.u0, b, c.v0);
+        linear_combination(next_b, b, c.v1, a, c.u1);
+    } else {
+        linear_combination(next_a, b, c.v0, a, c.u0);
+        linear_combination(next_b, a, c.u1, b, c.v1);
+    }
+    a.swap(next_a);
+    b.swap(next_b);
+}
+
+big_integer signed_combination(const big_integer& x, uint64_t cx, const big_integer& y, uint64_t cy) {
+    big_integer result = 0;
+    addmul(result, x, big_integer(cx));
+    submul(result, y, big_integer(cy));
+    return result;
+}
+
+// Whether r^k > n, without overflowing.
+bool power_exceeds(uint64_t r, uint32_t k, uint64_t n) {
+    uint64_t result = 1;
+    for (uint32_t i = 0; i < k; ++i) {
+        if (r != 0 && result > n / r) {
+            return true;
+        }
+        result *= r;
+    }
+    return result > n;
+}
+
+uint64_t iroot64(uint64_t n, uint32_t k) {
+    auto r = static_cast<uint64_t>(std::pow(static_cast<double>(n), 1.0 / k));
+    while (r > 0 && power_exceeds(r, k, n)) {
+        --r;
+    }
+    while (!power_exceeds(r + 1, k, n)) {
+        ++r;
+    }
+    return r;
+}
+
+big_integer power(big_integer a, uint32_t k) {
+    big_integer result = 1;
+    while (k > 0) {
+        if (k & 1) {
+            result *= a;
+        }
+        k >>= 1;
+        if (k > 0) {
+            a *= a;
+        }
+    }
+    return result;
+}
+
+template <uint32_t M>
+constexpr std::array<bool, M> quadratic_residues() {
+    std::array<bool, M> result{};
+    for (uint64_t i = 0; i < M; ++i) {
+        result[i * i % M] = true;
+    }
+    return result;
+}
+
+constexpr std::array<bool, 64> SQUARES_MOD_64 = quadratic_residues<64>();
+constexpr std::array<bool, 3> SQUARES_MOD_3 = quadratic_residues<3>();
+constexpr std::array<bool, 5> SQUARES_MOD_5 = quadratic_residues<5>();
+constexpr std::array<bool, 17> SQUARES_MOD_17 = quadratic_residues<17>();
+constexpr std::array<bool, 257> SQUARES_MOD_257 = quadratic_residues<257>();
+
+const uint64_t RANGE_PRODUCT_LEAF = 16;
+const uint64_t BINOMIAL_SIEVE_RATIO = 64;
+
+void append_factor(std::vector<big_integer>& factors, uint64_t& packed, uint64_t factor) {
+    if (packed > UINT64_MAX / factor) {
+        factors.emplace_back(packed);
+        packed = 1;
+    }
+    packed *= factor;
+}
+
+// Multiplies neighbours level by level, so that every multiplication gets operands of similar size.
+big_integer product_tree(std::vector<big_integer> factors) {
+    if (factors.empty()) {
+        return 1;
+    }
+    while (factors.size() > 1) {
+        size_t half = (factors.size() + 1) / 2;
+        for (size_t i = 0; i < factors.size() / 2; ++i) {
+            factors[i] = factors[2 * i] * factors[2 * i + 1];
+        }
+        if (factors.size() % 2 == 1) {
+            factors[half - 1] = factors.back();
+        }
+        factors.resize(half);
+    }
+    return factors[0];
+}
+
+// Product of first, first + step, ..., first + (count - 1) * step, split in halves down to word-packed leaves.
+big_integer range_product(uint64_t first, uint64_t count, uint64_t step) {
+    if (count <= RANGE_PRODUCT_LEAF) {
+        std::vector<big_integer> factors;
+        uint64_t packed = 1;
+        for (uint64_t i = 0; i < count; ++i) {
+            append_factor(factors, packed, first + i * step);
+        }
+        factors.emplace_back(packed);
+        return product_tree(std::move(factors));
+    }
+    uint64_t half = count / 2;
+    return range_product(first, half, step) * range_product(first + half * step, count - half, step);
+}
+
+big_integer odd_product(uint64_t lo, uint64_t hi) {
+    lo |= 1;
+    if (hi % 2 == 0) {
+        --hi;
+    }
+    if (hi == UINT64_MAX || lo > hi) {
+        return 1;
+    }
+    return range_product(lo, (hi - lo) / 2 + 1, 2);
+}
+
+// C(n, k) as a product of prime powers; the exponent of p is the number of carries when adding k and n - k
+// in base p (Kummer), so no division is needed.
+big_integer binomial_by_primes(uint64_t n, uint64_t k) {
+    std::vector<bool> composite(n / 2 + 1);
+    std::vector<big_integer> factors;
+    uint64_t packed = 1;
+    for (uint64_t p = 2; p <= n; p = (p == 2 ? 3 : p + 2)) {
+        if (p > 2 && composite[p / 2]) {
+            continue;
+        }
+        if (p > 2) {
+            for (uint64_t multiple = p * p; multiple <= n; multiple += 2 * p) {
+                composite[multiple / 2] = true;
+            }
+        }
+        uint64_t exponent = 0;
+        for (uint64_t q = p; q <= n; q *= p) {
+            exponent += n / q - k / q - (n - k) / q;
+            if (q > n / p) {
+                break;
+            }
+        }
+        for (uint64_t i = 0; i < exponent; ++i) {
+            append_factor(factors, packed, p);
+        }
+    }
+    factors.emplace_back(packed);
+    return product_tree(std::move(factors));
+}
+
+// Runs body(i) for every i < count. With a pool, consecutive indices are grouped into tasks once their
+// operands reach multiplication_cutoff limbs, so levels of small numbers stay on the calling thread just
+// like Karatsuba subproducts below the same cutoff.
+void for_each_node(thread_pool* workers, size_t count, const std::function<size_t(size_t)>& limbs,
+                   const std::function<void(size_t)>& body) {
+    if (workers == nullptr) {
+        for (size_t i = 0; i < count; ++i) {
+            body(i);
+        }
+        return;
+    }
+    size_t cutoff = get_parallel_options().multiplication_cutoff;
+    task_group group(*workers);
+    size_t begin = 0;
+    size_t total = 0;
+    for (size_t i = 0; i + 1 < count; ++i) {
+        total += limbs(i);
+        if (total >= cutoff) {
+            group.run([&body, begin, end = i + 1] {
+                for (size_t j = begin; j < end; ++j) {
+                    body(j);
+                }
+            });
+            begin = i + 1;
+            total = 0;
+        }
+    }
+    for (size_t i = begin; i < count; ++i) {
+        body(i);
+    }
+    group.wait();
+}
+
+} // namespace
+
+// A run of Euclidean steps taken by the half-GCD. Like every product of the step matrices [[q, 1], [1, 0]],
+// the matrix has non-negative entries and a determinant of 1, or -1 when odd is set, and maps the reduced
+// pair (alpha, beta) back to the original one: a = m00 * alpha + m01 * beta, b = m10 * alpha + m11 * beta.
+struct half_gcd {
+public:
+    half_gcd() = default;
+    // Without accumulate, only the operands are reduced and the matrix stays the identity, which is all
+    // that gcd needs at the top level.
+    explicit half_gcd(bool accumulate) : accumulate(accumulate) {}
+
+    big_integer m00 = 1;
+    big_integer m01 = 0;
+    big_integer m10 = 0;
+    big_integer m11 = 1;
+    bool odd = false;
+
+    // Reduces a, b >= 0 in place until b has at most `stop` bits, which must be at least half of the bits
+    // of the larger one, and appends the steps taken.
+    void reduce(big_integer& a, big_integer& b, size_t stop);
+
+private:
+    bool accumulate = true;
+
+    // Bits left above the stopping point of a recursive reduction of the leading bits, so that the steps
+    // it finds are also valid for the whole numbers despite the bits it didn't see.
+    static const size_t MARGIN = 64;
+
+    void reduce_leading(big_integer& a, big_integer& b, size_t shift, size_t stop);
+    void lehmer_steps(big_integer& a, big_integer& b, size_t stop);
+    void euclidean_step(big_integer& a, big_integer& b);
+    void append(const big_integer& n00, const big_integer& n01, const big_integer& n10, const big_integer& n11,
+                bool negative_determinant);
+    void apply_inverse(big_integer& a, big_integer& b) const;
+};
+
+// Thull and Yap's half-GCD on bits: the leading half of what is to be removed is reduced recursively and
+// applied to the whole numbers, then the leading bits of the rest, and Lehmer steps finish off.
+void half_gcd::reduce(big_integer& a, big_integer& b, size_t stop) {
+    if (a < b) {
+        euclidean_step(a, b);
+    }
+    if (b.bit_length() <= stop) {
+        return;
+    }
+    if (a.limbs().size() >= get_algorithm_thresholds().half_gcd) {
+        size_t length = a.bit_length();
+        size_t excess = length - stop;
+        reduce_leading(a, b, stop, excess / 2 + MARGIN);
+        length = a.bit_length();
+        if (b.bit_length() > stop && 2 * stop > length) {
+            reduce_leading(a, b, 2 * stop - length, length - stop + MARGIN);
+        }
+    }
+    lehmer_steps(a, b, stop);
+}
+
+// Reduces a >> shift and b >> shift until the second one has at most `stop` bits and, if the steps turn
+// out to be valid for a and b, applies them. The leading bits come out of the recursion already
+// transformed, so only the low `shift` bits are multiplied by the matrix.
+void half_gcd::reduce_leading(big_integer& a, big_integer& b, size_t shift, size_t stop) {
+    big_integer a_leading = a >> static_cast<int>(shift);
+    big_integer b_leading = b >> static_cast<int>(shift);
+    if (b_leading.bit_length() <= stop) {
+        return;
+    }
+    big_integer a_low = a - (a_leading << static_cast<int>(shift));
+    big_integer b_low = b - (b_leading << static_cast<int>(shift));
+    half_gcd steps;
+    steps.reduce(a_leading, b_leading, stop);
+    steps.apply_inverse(a_low, b_low);
+    a_low += a_leading << static_cast<int>(shift);
+    b_low += b_leading << static_cast<int>(shift);
+    if (a_low < 0 || b_low < 0) {
+        return;
+    }
+    a.swap(a_low);
+    b.swap(b_low);
+    append(steps.m00, steps.m01, steps.m10, steps.m11, steps.odd);
+}
+
+void half_gcd::lehmer_steps(big_integer& a, big_integer& b, size_t stop) {
+    std::pmr::vector<uint32_t> next_a(a.value.get_allocator());
+    std::pmr::vector<uint32_t> next_b(a.value.get_allocator());
+    while (b.bit_length() > stop) {
+        lehmer_cofactors c;
+        if (b.limbs().size() > 1 && a >= b) {
+            a.promote();
+            b.promote();
+            c = lehmer_simulate(a.value, b.value);
+        }
+        if (c.v0 == 0) {
+            euclidean_step(a, b);
+            continue;
+        }
+        lehmer_update(a.value, b.value, c, next_a, next_b);
+        // The cosequence inverts to the product [[v1, v0], [u1, u0]] of the steps it reproduces.
+        append(big_integer(c.v1), big_integer(c.v0), big_integer(c.u1), big_integer(c.u0), !c.even);
+    }
+}
+
+void half_gcd::euclidean_step(big_integer& a, big_integer& b) {
+    big_integer q = a / b;
+    big_integer r = a - q * b;
+    a.swap(b);
+    b.swap(r);
+    append(q, 1, 1, 0, true);
+}
+
+// Multiplies the matrix from the right by [[n00, n01], [n10, n11]].
+void half_gcd::append(const big_integer& n00, const big_integer& n01, const big_integer& n10,
+                      const big_integer& n11, bool negative_determinant) {
+    if (!accumulate) {
+        return;
+    }
+    big_integer next_m00 = m00 * n00;
+    addmul(next_m00, m01, n10);
+    big_integer next_m01 = m00 * n01;
+    addmul(next_m01, m01, n11);
+    big_integer next_m10 = m10 * n00;
+    addmul(next_m10, m11, n10);
+    big_integer next_m11 = m10 * n01;
+    addmul(next_m11, m11, n11);
+    m00.swap(next_m00);
+    m01.swap(next_m01);
+    m10.swap(next_m10);
+    m11.swap(next_m11);
+    odd = odd != negative_determinant;
+}
+
+// (a, b) = the matrix inverse times (a, b), which may be negative for arbitrary a and b.
+void half_gcd::apply_inverse(big_integer& a, big_integer& b) const {
+    big_integer alpha = m11 * a;
+    submul(alpha, m01, b);
+    big_integer beta = m00 * b;
+    submul(beta, m10, a);
+    if (odd) {
+        alpha = -alpha;
+        beta = -beta;
+    }
+    a.swap(alpha);
+    b.swap(beta);
+}
+
+big_integer gcd(const big_integer& a, const big_integer& b) {
+    big_integer x = a;
+    big_integer y = b;
+    x.is_negative = false;
+    y.is_negative = false;
+    if (x < y) {
+        x.swap(y);
+    }
+    size_t threshold = get_algorithm_thresholds().half_gcd;
+    while (y.limbs().size() >= threshold) {
+        size_t stop = x.bit_length() / 2 + 1;
+        if (y.bit_length() > stop) {
+            half_gcd steps(false);
+            steps.reduce(x, y, stop);
+        } else {
+            x %= y;
+            x.swap(y);
+        }
+    }
+    std::pmr::vector<uint32_t> next_x(x.value.get_allocator());
+    std::pmr::vector<uint32_t> next_y(x.value.get_allocator());
+    while (y.limbs().size() > 1) {
+        x.promote();
+        y.promote();
+        lehmer_cofactors c = lehmer_simulate(x.value, y.value);
+        if (c.v0 != 0) {
+            lehmer_update(x.value, y.value, c, next_x, next_y);
+        } else {
+            x %= y;
+            x.swap(y);
+        }
+    }
+    if (y == 0) {
+        return x;
+    }
+    x.mod_to_short(y.limbs()[0]);
+    uint32_t u = y.limbs()[0];
+    uint32_t v = x.limbs()[0];
+    while (v != 0) {
+        u %= v;
+        std::swap(u, v);
+    }
+    return u;
+}
+
+std::tuple<big_integer, big_integer, big_integer> xgcd(const big_integer& a, const big_integer& b) {
+    big_integer x = a;
+    big_integer y = b;
+    x.is_negative = false;
+    y.is_negative = false;
+    bool swapped = x < y;
+    if (swapped) {
+        x.swap(y);
+    }
+    // Invariants: x == ux * |first| (mod |second|) and y == uy * |first| (mod |second|),
+    // where first is the larger of |a| and |b|.
+    big_integer ux = 1;
+    big_integer uy = 0;
+    size_t threshold = get_algorithm_thresholds().half_gcd;
+    bool halved = false;
+    while (y.limbs().size() >= threshold) {
+        size_t stop = x.bit_length() / 2 + 1;
+        if (y.bit_length() > stop) {
+            half_gcd steps;
+            steps.reduce(x, y, stop);
+            big_integer next_ux = steps.m11 * ux;
+            submul(next_ux, steps.m01, uy);
+            big_integer next_uy = steps.m00 * uy;
+            submul(next_uy, steps.m10, ux);
+            if (steps.odd) {
+                next_ux = -next_ux;
+                next_uy = -next_uy;
+            }
+            ux.swap(next_ux);
+            uy.swap(next_uy);
+            halved = true;
+        } else {
+            big_integer q = x / y;
+            big_integer r = x - q * y;
+            x.swap(y);
+            y.swap(r);
+            big_integer next_uy = ux - q * uy;
+            ux.swap(uy);
+            uy.swap(next_uy);
+        }
+    }
+    std::pmr::vector<uint32_t> next_x(x.value.get_allocator());
+    std::pmr::vector<uint32_t> next_y(x.value.get_allocator());
+    while (y != 0) {
+        lehmer_cofactors c;
+        if (y.limbs().size() > 1) {
+            x.promote();
+            y.promote();
+            c = lehmer_simulate(x.value, y.value);
+        }
+        if (c.v0 != 0) {
+            lehmer_update(x.value, y.value, c, next_x, next_y);
+            big_integer next_ux = c.even ? signed_combination(ux, c.u0, uy, c.v0) : signed_combination(uy, c.v0, ux, c.u0);
+            big_integer next_uy = c.even ? signed_combination(uy, c.v1, ux, c.u1) : signed_combination(ux, c.u1, uy, c.v1);
+            ux.swap(next_ux);
+            uy.swap(next_uy);
+        } else {
+            big_integer q = x / y;
+            big_integer r = x - q * y;
+            x.swap(y);
+            y.swap(r);
+            big_integer next_uy = ux - q * uy;
+            ux.swap(uy);
+            uy.swap(next_uy);
+        }
+    }
+    const big_integer& first = swapped ? b : a;
+    const big_integer& second = swapped ? a : b;
+    if (halved) {
+        // Half-GCD steps that merely keep the operands valid can leave ux larger than Euclid's cofactor,
+        // which is reduced to at most half of the period |second| / gcd.
+        big_integer period = second / x;
+        period.is_negative = false;
+        ux %= period;
+        if (2 * ux > period) {
+            ux -= period;
+        } else if (2 * ux < -period) {
+            ux += period;
+        }
+    }
+    if (first.is_negative) {
+        ux = -ux;
+    }
+    big_integer other = second == 0 ? big_integer(0) : (x - first * ux) / second;
+    if (swapped) {
+        return {x, other, ux};
+    }
+    return {x, ux, other};
+}
+
+big_integer mod_inverse(const big_integer& a, const big_integer& m) {
+    if (m <= 0) {
+        throw std::invalid_argument("Modulus must be positive");
+    }
+    auto [g, x, y] = xgcd(a % m, m);
+    if (g != 1) {
+        throw std::invalid_argument("Number is not invertible modulo m");
+    }
+    x %= m;
+    if (x < 0) {
+        x += m;
+    }
+    return x;
+}
+
+big_integer isqrt(const big_integer& a) {
+    return iroot(a, 2);
+}
+
+// Newton's iteration from above. The starting point comes from the root of the number truncated to about
+// half of the root's precision, so every recursion level doubles the number of correct bits and the
+// full-size iteration only has to fix the last few of them.
+big_integer iroot(const big_integer& a, uint32_t k) {
+    if (k == 0) {
+        throw std::invalid_argument("Root degree can't be zero");
+    }
+    if (a < 0) {
+        if (k % 2 == 0) {
+            throw std::invalid_argument("Even root of a negative number");
+        }
+        return -iroot(-a, k);
+    }
+    if (k == 1 || a == 0) {
+        return a;
+    }
+    size_t bits = a.bit_length();
+    if (bits <= std::numeric_limits<uint64_t>::digits) {
+        uint64_t n;
+        a.get_inline(n);
+        return iroot64(n, k);
+    }
+    size_t shift = bits / k / 2;
+    big_integer x;
+    if (shift == 0) {
+        x = big_integer(1) << static_cast<int>(bits / k + 1);
+    } else {
+        x = (iroot(a >> static_cast<int>(shift * k), k) + 1) << static_cast<int>(shift);
+    }
+    while (true) {
+        big_integer y = x;
+        y.mul_to_short(k - 1);
+        y += a / power(x, k - 1);
+        y.div_to_short(k);
+        if (y >= x) {
+            return x;
+        }
+        x.swap(y);
+    }
+}
+
+bool is_perfect_square(const big_integer& a) {
+    if (a < 0) {
+        return false;
+    }
+    if (a == 0) {
+        return true;
+    }
+    std::span<const uint32_t> digits = a.limbs();
+    if (!SQUARES_MOD_64[digits[0] % 64]) {
+        return false;
+    }
+    // 2^32 - 1 = 3 * 5 * 17 * 257 * 65537 and 2^32 == 1 modulo it, so the residue is a plain limb sum.
+    uint64_t sum = 0;
+    for (uint32_t digit : digits) {
+        sum += digit;
+        if (sum > UINT32_MAX) {
+            sum -= UINT32_MAX;
+        }
+    }
+    if (!SQUARES_MOD_3[sum % 3] || !SQUARES_MOD_5[sum % 5] || !SQUARES_MOD_17[sum % 17] ||
+        !SQUARES_MOD_257[sum % 257]) {
+        return false;
+    }
+    big_integer root = isqrt(a);
+    return root * root == a;
+}
+
+big_integer product_range(uint64_t lo, uint64_t hi) {
+    if (lo > hi) {
+        return 1;
+    }
+    if (lo == 0) {
+        return 0;
+    }
+    return range_product(lo, hi - lo + 1, 1);
+}
+
+// n! = 2^(n - popcount(n)) * prod over i of (product of odd numbers not exceeding n / 2^i).
+big_integer factorial(uint64_t n) {
+    if (n < 2) {
+        return 1;
+    }
+    big_integer result = 1;
+    big_integer odd = 1;
+    for (int i = std::bit_width(n) - 1; i >= 0; --i) {
+        odd *= odd_product((n >> (i + 1)) + 1, n >> i);
+        result *= odd;
+    }
+    return result << static_cast<int>(n - std::popcount(n));
+}
+
+big_integer binomial(uint64_t n, uint64_t k) {
+    if (k > n) {
+        return 0;
+    }
+    k = std::min(k, n - k);
+    if (k == 0) {
+        return 1;
+    }
+    if (n <= UINT32_MAX && n / k < BINOMIAL_SIEVE_RATIO) {
+        return binomial_by_primes(n, k);
+    }
+    return product_range(n - k + 1, n) / factorial(k);
+}
+
+// Bernstein's batch gcd: a product tree over the moduli, then a remainder tree that reduces the full product
+// modulo the square of every node, so that each leaf ends up with (P / n) mod n. Nodes of one level are
+// independent and run as tasks on the pool of the parallel options.
+std::vector<big_integer> batch_gcd(const std::vector<big_integer>& moduli) {
+    if (moduli.empty()) {
+        return {};
+    }
+    // Nodes are assigned from worker threads, so they can't live in a resource of the calling thread.
+    big_integer_memory_scope heap(std::pmr::new_delete_resource());
+    std::vector<std::vector<big_integer>> tree(1);
+    for (const big_integer& n : moduli) {
+        if (n == 0) {
+            throw std::invalid_argument("Moduli can't be zero");
+        }
+        tree[0].push_back(n < 0 ? -n : n);
+    }
+    thread_pool* workers = big_integer::workers();
+    while (tree.back().size() > 1) {
+        const std::vector<big_integer>& level = tree.back();
+        std::vector<big_integer> next((level.size() + 1) / 2);
+        for_each_node(
+            workers, next.size(),
+            [&](size_t i) {
+                return level[2 * i].limbs().size() + (2 * i + 1 < level.size() ? level[2 * i + 1].limbs().size() : 0);
+            },
+            [&](size_t i) { next[i] = 2 * i + 1 < level.size() ? level[2 * i] * level[2 * i + 1] : level[2 * i]; });
+        tree.push_back(std::move(next));
+    }
+    std::vector<big_integer> remainders = tree.back();
+    for (size_t depth = tree.size() - 1; depth > 0; --depth) {
+        const std::vector<big_integer>& level = tree[depth - 1];
+        std::vector<big_integer> next(level.size());
+        for_each_node(
+            workers, next.size(), [&](size_t i) { return remainders[i / 2].limbs().size(); },
+            [&](size_t i) { next[i] = remainders[i / 2] % (level[i] * level[i]); });
+        remainders.swap(next);
+    }
+    std::vector<big_integer> result(moduli.size());
+    for_each_node(
+        workers, result.size(), [&](size_t i) { return remainders[i].limbs().size(); },
+        [&](size_t i) { result[i] = gcd(remainders[i] / tree[0][i], tree[0][i]); });
+    return result;
+}
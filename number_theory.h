@@ -0,0 +1,22 @@
+#pragma once
+
+#include "big_integer.h"
+
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+big_integer gcd(const big_integer& a, const big_integer& b);
+std::tuple<big_integer, big_integer, big_integer> xgcd(const big_integer& a, const big_integer& b);
+big_integer mod_inverse(const big_integer& a, const big_integer& m);
+
+big_integer isqrt(const big_integer& a);
+big_integer iroot(const big_integer& a, uint32_t k);
+bool is_perfect_square(const big_integer& a);
+
+big_integer product_range(uint64_t lo, uint64_t hi);
+big_integer factorial(uint64_t n);
+big_integer binomial(uint64_t n, uint64_t k);
+
+// For every element, the gcd with the product of all the other elements.
+std::vector<big_integer> batch_gcd(const std::vector<big_integer>& moduli);
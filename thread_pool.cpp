@@ -0,0 +1,140 @@
+#include "thread_pool.h"
+
+#include <utility>
+
+namespace {
+
+thread_local const thread_pool* current_pool = nullptr;
+thread_local size_t current_index = 0;
+
+} // namespace
+
+thread_pool::thread_pool(size_t threads) {
+    size_t worker_count = threads > 1 ? threads - 1 : 0;
+    for (size_t i = 0; i < worker_count; ++i) {
+        queues.push_back(std::make_unique<worker_queue>());
+    }
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers.emplace_back(&thread_pool::worker_loop, this, i);
+    }
+}
+
+thread_pool::~thread_pool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    wake_up.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+size_t thread_pool::size() const {
+    return workers.size() + 1;
+}
+
+void thread_pool::push(task t) {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        ++queued;
+    }
+    worker_queue& queue = current_pool == this ? *queues[current_index] : shared_queue;
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(t));
+    }
+    wake_up.notify_one();
+}
+
+bool thread_pool::pop(worker_queue& queue, bool from_back, task& result) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    if (from_back) {
+        result = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+    } else {
+        result = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+    }
+    --queued;
+    return true;
+}
+
+bool thread_pool::try_run_one() {
+    task t;
+    bool is_worker = current_pool == this;
+    bool found = is_worker && pop(*queues[current_index], true, t);
+    for (size_t i = 0; !found && i < queues.size(); ++i) {
+        size_t victim = is_worker ? (current_index + 1 + i) % queues.size() : i;
+        if (!is_worker || victim != current_index) {
+            found = pop(*queues[victim], false, t);
+        }
+    }
+    if (!found) {
+        found = pop(shared_queue, false, t);
+    }
+    if (found) {
+        execute(t);
+    }
+    return found;
+}
+
+void thread_pool::execute(task& t) {
+    task_group* group = t.group;
+    try {
+        t.function();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(group->error_mutex);
+        if (!group->error) {
+            group->error = std::current_exception();
+        }
+    }
+    t.function = nullptr;
+    group->pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void thread_pool::worker_loop(size_t index) {
+    current_pool = this;
+    current_index = index;
+    while (true) {
+        if (try_run_one()) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        wake_up.wait(lock, [this] { return stopping || queued > 0; });
+        if (stopping && queued == 0) {
+            return;
+        }
+    }
+}
+
+task_group::task_group(thread_pool& pool) : pool(pool) {}
+
+task_group::~task_group() {
+    while (pending.load(std::memory_order_acquire) > 0) {
+        if (!pool.try_run_one()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void task_group::run(std::function<void()> function) {
+    pending.fetch_add(1, std::memory_order_relaxed);
+    pool.push({std::move(function), this});
+}
+
+void task_group::wait() {
+    while (pending.load(std::memory_order_acquire) > 0) {
+        if (!pool.try_run_one()) {
+            std::this_thread::yield();
+        }
+    }
+    std::lock_guard<std::mutex> lock(error_mutex);
+    if (error) {
+        std::exception_ptr rethrown = std::exchange(error, nullptr);
+        std::rethrow_exception(rethrown);
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct task_group;
+
+// Work-stealing pool for fork-join parallelism. Every worker owns a deque: it pushes and pops its own
+// tasks at the back and steals from the front of the others. Threads outside the pool submit through a
+// shared queue. A thread waiting for a task_group keeps executing tasks instead of blocking, so nested
+// groups never deadlock.
+struct thread_pool {
+public:
+    explicit thread_pool(size_t threads);
+    thread_pool(const thread_pool& other) = delete;
+    ~thread_pool();
+
+    thread_pool& operator=(const thread_pool& other) = delete;
+
+    size_t size() const;
+
+private:
+    struct task {
+        std::function<void()> function;
+        task_group* group;
+    };
+
+    struct worker_queue {
+        std::mutex mutex;
+        std::deque<task> tasks;
+    };
+
+    std::vector<std::unique_ptr<worker_queue>> queues;
+    worker_queue shared_queue;
+    std::vector<std::thread> workers;
+
+    std::mutex sleep_mutex;
+    std::condition_variable wake_up;
+    std::atomic<size_t> queued = 0;
+    bool stopping = false;
+
+    void push(task t);
+    bool try_run_one();
+    bool pop(worker_queue& queue, bool from_back, task& result);
+    void execute(task& t);
+    void worker_loop(size_t index);
+
+    friend struct task_group;
+};
+
+struct task_group {
+public:
+    explicit task_group(thread_pool& pool);
+    task_group(const task_group& other) = delete;
+    ~task_group();
+
+    task_group& operator=(const task_group& other) = delete;
+
+    void run(std::function<void()> function);
+    // Blocks until every task of the group has finished, running pending tasks meanwhile.
+    // Rethrows the first exception thrown by a task.
+    void wait();
+
+private:
+    thread_pool& pool;
+    std::atomic<size_t> pending = 0;
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    friend struct thread_pool;
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "big_integer.h"
+
+// Portable defaults. `cmake --build <dir> --target tune` writes the crossovers measured by bigint_tune on the
+// build machine to tuned_thresholds.h in <dir>, which takes precedence over this file on the include path.
+inline constexpr algorithm_thresholds TUNED_THRESHOLDS = {
+    .karatsuba_multiplication = 48,
+    .karatsuba_square = 64,
+    .add_product_rows = 48,
+    .decimal_conversion = 64,
+    .half_gcd = 1024,
+};
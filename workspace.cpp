@@ -0,0 +1,47 @@
+#include "workspace.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace {
+
+const size_t MIN_CHUNK_LIMBS = 1 << 12;
+
+struct workspace {
+    std::vector<std::unique_ptr<uint32_t[]>> chunks;
+    std::vector<size_t> capacities;
+    size_t chunk = 0;
+    size_t used = 0;
+};
+
+thread_local workspace current;
+
+} // namespace
+
+workspace_frame::workspace_frame() : chunk(current.chunk), used(current.used) {}
+
+workspace_frame::~workspace_frame() {
+    current.chunk = chunk;
+    current.used = used;
+}
+
+// Chunks that are too small for a request are skipped until the frame ends, and a new chunk is at least
+// twice as large as the last one, so the number of chunks stays logarithmic in the peak usage.
+uint32_t* workspace_frame::allocate(size_t limbs) {
+    while (current.chunk < current.chunks.size() && current.used + limbs > current.capacities[current.chunk]) {
+        ++current.chunk;
+        current.used = 0;
+    }
+    if (current.chunk == current.chunks.size()) {
+        size_t last = current.capacities.empty() ? 0 : current.capacities.back();
+        size_t capacity = std::max({limbs, MIN_CHUNK_LIMBS, 2 * last});
+        current.chunks.push_back(std::make_unique_for_overwrite<uint32_t[]>(capacity));
+        current.capacities.push_back(capacity);
+    }
+    uint32_t* result = current.chunks[current.chunk].get() + current.used;
+    current.used += limbs;
+    return result;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Scratch limbs for the temporaries of internal algorithms. Every thread owns a grow-only stack of
+// chunks that is never returned to the heap, so once it has grown to the working set of a computation,
+// temporaries cost no allocations. A frame releases everything allocated through it when it ends;
+// frames of one thread must end in reverse order of creation.
+struct workspace_frame {
+public:
+    workspace_frame();
+    workspace_frame(const workspace_frame& other) = delete;
+    ~workspace_frame();
+
+    workspace_frame& operator=(const workspace_frame& other) = delete;
+
+    // Uninitialized limbs that stay valid until the frame ends.
+    uint32_t* allocate(size_t limbs);
+
+private:
+    size_t chunk;
+    size_t used;
+};